@@ -59,6 +59,7 @@
 #define configUSE_QUEUE_SETS                       1
 #define configUSE_TASK_NOTIFICATIONS               1
 #define configSUPPORT_STATIC_ALLOCATION            1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS    2 /* The console buffer of the task - see console.c - and the semaphore profiler's wait start. */
 
 /* Software timer related configuration options.  The maximum possible task
  * priority is configMAX_PRIORITIES - 1.  The priority of the timer task is
@@ -75,6 +76,7 @@
 unsigned long ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
 void vConfigureTimerForRunTimeStats( void );    /* Prototype of function that initialises the run time counter. */
 #define configGENERATE_RUN_TIME_STATS             1
+#define configRUN_TIME_COUNTER_TYPE               uint64_t /* Per task totals in ns would wrap every 4.3 s on 32 bits. */
 
 /* Co-routine related configuration options. */
 #define configUSE_CO_ROUTINES                     0
@@ -127,6 +129,12 @@ extern void vAssertCalled( const char * const pcFileName,
     #error projCOVERAGE_TEST should be defined to 1 or 0 on the command line.
 #endif
 
+/* 'make SEM_PROFILER=1' replaces the FreeRTOS+Trace recorder by the
+ * semaphore profiler - see sem_profiler.h. */
+#ifndef projSEM_PROFILER
+    #define projSEM_PROFILER    0
+#endif
+
 #if ( projCOVERAGE_TEST == 1 )
 
 /* Insert NOPs in empty decision paths to ensure both true and false paths
@@ -152,8 +160,13 @@ extern void vAssertCalled( const char * const pcFileName,
 
     #define configUSE_MALLOC_FAILED_HOOK    1
 
-/* Include the FreeRTOS+Trace FreeRTOS trace macro definitions. */
-    #include "trcRecorder.h"
+/* Include the FreeRTOS+Trace FreeRTOS trace macro definitions, or those of
+ * the semaphore profiler. */
+    #if ( projSEM_PROFILER == 1 )
+        #include "sem_profiler_hooks.h"
+    #else
+        #include "trcRecorder.h"
+    #endif
 #endif /* if ( projCOVERAGE_TEST == 1 ) */
 
 /* networking definitions */
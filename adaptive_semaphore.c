@@ -0,0 +1,132 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Spin-then-block semaphore wrapper - see adaptive_semaphore.h.
+*----------------------------------------------------------*/
+
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "adaptive_semaphore.h"
+
+/* Weight of a new hold time in the moving average: 1 / 2^adaptiveAVERAGE_SHIFT */
+#define adaptiveAVERAGE_SHIFT    ( 3 )
+
+/*-----------------------------------------------------------*/
+
+void vAdaptiveSemaphoreInit( AdaptiveSemaphore_t * pxAdaptive,
+                             SemaphoreHandle_t xSemaphore )
+{
+    memset( pxAdaptive, 0, sizeof( *pxAdaptive ) );
+    pxAdaptive->xSemaphore = xSemaphore;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulAdaptiveSemaphoreSpinBudget( const AdaptiveSemaphore_t * pxAdaptive )
+{
+    unsigned long ulAverage = pxAdaptive->ulHoldAverage;
+
+    return ( ulAverage > adaptiveMAX_SPIN ) ? 0 : 2 * ulAverage;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAdaptiveSemaphoreTake( AdaptiveSemaphore_t * pxAdaptive,
+                                   TickType_t xTicksToWait )
+{
+    unsigned long ulBudget;
+    unsigned long ulStart;
+    TickType_t xStartTick;
+    TickType_t xElapsedTicks;
+
+    if( xSemaphoreTake( pxAdaptive->xSemaphore, 0 ) == pdTRUE )
+    {
+        pxAdaptive->ulImmediate++;
+        pxAdaptive->ulTakenAt = ulGetRunTimeCounterValue();
+        return pdTRUE;
+    }
+
+    ulBudget = ulAdaptiveSemaphoreSpinBudget( pxAdaptive );
+
+    if( ( ulBudget > 0 ) && ( xTicksToWait > 0 ) )
+    {
+        ulStart = ulGetRunTimeCounterValue();
+        xStartTick = xTaskGetTickCount();
+
+        do
+        {
+            /* Lets the holder run if it has the same priority. */
+            taskYIELD();
+
+            if( xSemaphoreTake( pxAdaptive->xSemaphore, 0 ) == pdTRUE )
+            {
+                pxAdaptive->ulSpinAcquired++;
+                pxAdaptive->ulTakenAt = ulGetRunTimeCounterValue();
+                return pdTRUE;
+            }
+        } while( ulGetRunTimeCounterValue() - ulStart < ulBudget );
+
+        /* The time spent spinning is part of the time allowed to wait. */
+        xElapsedTicks = xTaskGetTickCount() - xStartTick;
+
+        if( xTicksToWait != portMAX_DELAY )
+        {
+            xTicksToWait = ( xElapsedTicks < xTicksToWait ) ? xTicksToWait - xElapsedTicks : 0;
+        }
+    }
+
+    if( xSemaphoreTake( pxAdaptive->xSemaphore, xTicksToWait ) == pdTRUE )
+    {
+        pxAdaptive->ulBlockAcquired++;
+        pxAdaptive->ulTakenAt = ulGetRunTimeCounterValue();
+        return pdTRUE;
+    }
+
+    /* The other counters are only updated by the holder. */
+    taskENTER_CRITICAL();
+    pxAdaptive->ulFailed++;
+    taskEXIT_CRITICAL();
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAdaptiveSemaphoreGive( AdaptiveSemaphore_t * pxAdaptive )
+{
+    unsigned long ulHold = ulGetRunTimeCounterValue() - pxAdaptive->ulTakenAt;
+    long lDelta = ( long ) ulHold - ( long ) pxAdaptive->ulHoldAverage;
+
+    /* Only the holder gets here, so the average needs no protection. */
+    pxAdaptive->ulHoldAverage = ( unsigned long ) ( ( long ) pxAdaptive->ulHoldAverage + lDelta / ( 1L << adaptiveAVERAGE_SHIFT ) );
+
+    return xSemaphoreGive( pxAdaptive->xSemaphore );
+}
+/*-----------------------------------------------------------*/
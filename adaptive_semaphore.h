@@ -0,0 +1,89 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ADAPTIVE_SEMAPHORE_H
+    #define ADAPTIVE_SEMAPHORE_H
+
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "semphr.h"
+
+    #include "run_time_stats.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Spin-then-block wrapper around a binary semaphore, a mutex or a counting
+* semaphore of maximum count 1.
+*
+* When the semaphore is not available, xAdaptiveSemaphoreTake() first keeps
+* retrying a zero timeout take, yielding to the tasks of the same priority in
+* between - the holder among them - for a budget of twice the average hold
+* time.  Only then does it block in the kernel.  The average hold time is
+* measured by xAdaptiveSemaphoreGive() and follows the workload, so long
+* critical sections stop spinning altogether (past adaptiveMAX_SPIN) while
+* short ones are mostly acquired without blocking.
+*
+* Times are in run time counter units - see ulGetRunTimeCounterValue().
+*----------------------------------------------------------*/
+
+/* Hold times above this (50 us) are never waited for by spinning.  With the
+ * run time counter in ticks it is 0, and the holds below a tick - all those
+ * worth spinning for - measure 0 as well: the spin budget is always 0, and
+ * the semaphore blocks like a plain one. */
+    #ifndef adaptiveMAX_SPIN
+        #define adaptiveMAX_SPIN    ( ( unsigned long ) ( 50ULL * runtimeCOUNTS_PER_SECOND / 1000000ULL ) )
+    #endif
+
+    typedef struct AdaptiveSemaphore
+    {
+        SemaphoreHandle_t xSemaphore;
+        unsigned long ulHoldAverage;  /* Moving average of the hold time. */
+        unsigned long ulTakenAt;      /* When the current holder got it. */
+
+        /* Statistics, not reset by the wrapper. */
+        uint32_t ulImmediate;         /* Takes that found the semaphore free. */
+        uint32_t ulSpinAcquired;      /* Takes that got it while spinning. */
+        uint32_t ulBlockAcquired;     /* Takes that had to block. */
+        uint32_t ulFailed;            /* Takes that timed out. */
+    } AdaptiveSemaphore_t;
+
+    void vAdaptiveSemaphoreInit( AdaptiveSemaphore_t * pxAdaptive,
+                                 SemaphoreHandle_t xSemaphore );
+    BaseType_t xAdaptiveSemaphoreTake( AdaptiveSemaphore_t * pxAdaptive,
+                                       TickType_t xTicksToWait );
+    BaseType_t xAdaptiveSemaphoreGive( AdaptiveSemaphore_t * pxAdaptive );
+
+/* Current spin budget, 0 when taking would block straight away. */
+    unsigned long ulAdaptiveSemaphoreSpinBudget( const AdaptiveSemaphore_t * pxAdaptive );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* ADAPTIVE_SEMAPHORE_H */
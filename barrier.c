@@ -0,0 +1,83 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Reusable N task barrier - see barrier.h.
+*----------------------------------------------------------*/
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+/* Local includes. */
+#include "barrier.h"
+
+/*-----------------------------------------------------------*/
+
+void vBarrierCreate( Barrier_t * pxBarrier,
+                     UBaseType_t uxParties )
+{
+    configASSERT( ( uxParties > 0 ) && ( uxParties <= barrierMAX_PARTIES ) );
+
+    pxBarrier->xEventGroup = xEventGroupCreateStatic( &pxBarrier->xEventGroupBuffer );
+    pxBarrier->uxAllBits = ( ( EventBits_t ) 1U << uxParties ) - 1U;
+    pxBarrier->uxParties = uxParties;
+    configASSERT( pxBarrier->xEventGroup );
+}
+/*-----------------------------------------------------------*/
+
+void vBarrierDelete( Barrier_t * pxBarrier )
+{
+    vEventGroupDelete( pxBarrier->xEventGroup );
+    pxBarrier->xEventGroup = NULL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBarrierWait( Barrier_t * pxBarrier,
+                         UBaseType_t uxParty,
+                         TickType_t xTicksToWait )
+{
+    EventBits_t uxOwnBit = ( EventBits_t ) 1U << uxParty;
+    EventBits_t uxBits;
+
+    configASSERT( uxParty < pxBarrier->uxParties );
+
+    uxBits = xEventGroupSync( pxBarrier->xEventGroup, uxOwnBit, pxBarrier->uxAllBits, xTicksToWait );
+
+    if( ( uxBits & pxBarrier->uxAllBits ) == pxBarrier->uxAllBits )
+    {
+        return pdTRUE;
+    }
+
+    /* Left on its own, the bit would let this party count as arrived in the
+     * next cycle.  If it is gone already, the last party arrived between the
+     * time-out and here: the sync completed, with this party counted in. */
+    uxBits = xEventGroupClearBits( pxBarrier->xEventGroup, uxOwnBit );
+
+    return ( ( uxBits & uxOwnBit ) == 0 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
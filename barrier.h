@@ -0,0 +1,81 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef BARRIER_H
+    #define BARRIER_H
+
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "event_groups.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Reusable barrier for a fixed set of tasks, built on an event group.
+*
+* Each of the uxParties tasks owns one event bit, given by its party number
+* (0 .. uxParties - 1).  xEventGroupSync() clears all the bits atomically
+* when the last task arrives, so the barrier is ready for the next cycle
+* as soon as the tasks are released.
+*
+* Only 24 event bits are usable when configUSE_16_BIT_TICKS is 0 (8 bits
+* otherwise), which bounds the number of parties.
+*----------------------------------------------------------*/
+
+    #if ( configUSE_16_BIT_TICKS == 1 )
+        #define barrierMAX_PARTIES    ( 8U )
+    #else
+        #define barrierMAX_PARTIES    ( 24U )
+    #endif
+
+    typedef struct Barrier
+    {
+        EventGroupHandle_t xEventGroup;
+        StaticEventGroup_t xEventGroupBuffer;
+        EventBits_t uxAllBits;
+        UBaseType_t uxParties;
+    } Barrier_t;
+
+    void vBarrierCreate( Barrier_t * pxBarrier,
+                         UBaseType_t uxParties );
+    void vBarrierDelete( Barrier_t * pxBarrier );
+
+/*
+ * Wait until all the parties have called xBarrierWait().  Returns pdFALSE if
+ * xTicksToWait elapsed (or the wait was aborted) first - the party is then
+ * withdrawn from the current cycle, so the barrier stays usable.
+ */
+    BaseType_t xBarrierWait( Barrier_t * pxBarrier,
+                             UBaseType_t uxParty,
+                             TickType_t xTicksToWait );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* BARRIER_H */
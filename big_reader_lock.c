@@ -0,0 +1,167 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Big-reader lock - see big_reader_lock.h.
+*----------------------------------------------------------*/
+
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+/* Local includes. */
+#include "big_reader_lock.h"
+
+#define brlockNO_WRITER_BIT    ( ( EventBits_t ) 0x01 )
+
+/* Waits after which a writer sleeps a tick before scanning again, rather than
+ * only yield - readers of a lower priority would not run otherwise. */
+#define brlockYIELD_WAITS      ( 8U )
+
+/*-----------------------------------------------------------*/
+
+void vBigReaderLockInit( BigReaderLock_t * pxLock,
+                         UBaseType_t uxSlotCount )
+{
+    configASSERT( ( uxSlotCount > 0 ) && ( uxSlotCount <= brlockMAX_SLOTS ) );
+
+    memset( pxLock, 0, sizeof( *pxLock ) );
+    pxLock->uxSlotCount = uxSlotCount;
+    pxLock->xWriterMutex = xSemaphoreCreateMutexStatic( &pxLock->xWriterMutexBuffer );
+    pxLock->xNoWriter = xEventGroupCreateStatic( &pxLock->xNoWriterBuffer );
+    xEventGroupSetBits( pxLock->xNoWriter, brlockNO_WRITER_BIT );
+}
+/*-----------------------------------------------------------*/
+
+void vBigReaderLockDelete( BigReaderLock_t * pxLock )
+{
+    vSemaphoreDelete( pxLock->xWriterMutex );
+    vEventGroupDelete( pxLock->xNoWriter );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBigReaderReadLock( BigReaderLock_t * pxLock,
+                               UBaseType_t uxSlot,
+                               TickType_t xTicksToWait )
+{
+    uint32_t * pulReaders = &pxLock->xSlots[ uxSlot % pxLock->uxSlotCount ].ulReaders;
+    TimeOut_t xTimeOut;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ; ; )
+    {
+        /* Announce the reader, then look for a writer - the writer does the
+         * opposite, so at least one of them sees the other. */
+        __atomic_add_fetch( pulReaders, 1U, __ATOMIC_SEQ_CST );
+
+        if( __atomic_load_n( &pxLock->ulWriter, __ATOMIC_SEQ_CST ) == 0U )
+        {
+            return pdTRUE;
+        }
+
+        __atomic_sub_fetch( pulReaders, 1U, __ATOMIC_SEQ_CST );
+        __atomic_add_fetch( &pxLock->ulReadRetries, 1U, __ATOMIC_RELAXED );
+
+        if( ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE ) ||
+            ( ( xEventGroupWaitBits( pxLock->xNoWriter, brlockNO_WRITER_BIT, pdFALSE, pdTRUE, xTicksToWait ) &
+                brlockNO_WRITER_BIT ) == 0 ) )
+        {
+            return pdFALSE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vBigReaderReadUnlock( BigReaderLock_t * pxLock,
+                           UBaseType_t uxSlot )
+{
+    __atomic_sub_fetch( &pxLock->xSlots[ uxSlot % pxLock->uxSlotCount ].ulReaders, 1U, __ATOMIC_RELEASE );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBigReaderWriteLock( BigReaderLock_t * pxLock,
+                                TickType_t xTicksToWait )
+{
+    uint32_t ulWaits = 0;
+    TimeOut_t xTimeOut;
+
+    /* xTicksToWait bounds the whole of it, the wait for the readers too. */
+    vTaskSetTimeOutState( &xTimeOut );
+
+    if( xSemaphoreTake( pxLock->xWriterMutex, xTicksToWait ) != pdTRUE )
+    {
+        return pdFALSE;
+    }
+
+    /* Readers arriving from now on wait for the bit to be set again. */
+    xEventGroupClearBits( pxLock->xNoWriter, brlockNO_WRITER_BIT );
+    __atomic_store_n( &pxLock->ulWriter, 1U, __ATOMIC_SEQ_CST );
+
+    /* The readers already in finish their read, whatever their number. */
+    for( UBaseType_t x = 0; x < pxLock->uxSlotCount; x++ )
+    {
+        while( __atomic_load_n( &pxLock->xSlots[ x ].ulReaders, __ATOMIC_ACQUIRE ) != 0U )
+        {
+            if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+            {
+                /* Lets the readers in again, as vBigReaderWriteUnlock(). */
+                pxLock->ulWriterWaits += ulWaits;
+                __atomic_store_n( &pxLock->ulWriter, 0U, __ATOMIC_SEQ_CST );
+                xEventGroupSetBits( pxLock->xNoWriter, brlockNO_WRITER_BIT );
+                xSemaphoreGive( pxLock->xWriterMutex );
+
+                return pdFALSE;
+            }
+
+            if( ++ulWaits < brlockYIELD_WAITS )
+            {
+                taskYIELD();
+            }
+            else
+            {
+                vTaskDelay( 1 );
+            }
+        }
+    }
+
+    pxLock->ulWriterWaits += ulWaits;
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vBigReaderWriteUnlock( BigReaderLock_t * pxLock )
+{
+    __atomic_store_n( &pxLock->ulWriter, 0U, __ATOMIC_SEQ_CST );
+    xEventGroupSetBits( pxLock->xNoWriter, brlockNO_WRITER_BIT );
+    xSemaphoreGive( pxLock->xWriterMutex );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,105 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef BIG_READER_LOCK_H
+    #define BIG_READER_LOCK_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "semphr.h"
+    #include "event_groups.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Big-reader lock: readers-writer lock with one reader count per slot.
+*
+* A reader only touches the counter of its own slot, and the writer flag,
+* which it reads - readers do not share any lock or any written location, so
+* their cost does not grow with their number.  The writer pays instead: it
+* raises the writer flag, then scans every slot until all of them are empty.
+* Readers that find the flag raised step back and wait on an event group
+* bit, set again when the writer leaves.  Writers are serialised by a mutex
+* and have precedence over the readers arriving after them.
+*
+* Each task reads from its own slot, given as uxSlot - tasks may share a
+* slot, at the cost of sharing its counter.
+*----------------------------------------------------------*/
+
+    #ifndef brlockMAX_SLOTS
+        #define brlockMAX_SLOTS    ( 256U )
+    #endif
+
+/* Slots are kept on cache lines of their own. */
+    #define brlockSLOT_SIZE        ( 64U )
+
+    typedef struct BigReaderSlot
+    {
+        uint32_t ulReaders;
+        uint8_t ucPadding[ brlockSLOT_SIZE - sizeof( uint32_t ) ];
+    } __attribute__( ( aligned( brlockSLOT_SIZE ) ) ) BigReaderSlot_t;
+
+    typedef struct BigReaderLock
+    {
+        BigReaderSlot_t xSlots[ brlockMAX_SLOTS ];
+        UBaseType_t uxSlotCount;
+        uint32_t ulWriter;                 /* Raised while a writer waits or writes. */
+        SemaphoreHandle_t xWriterMutex;
+        EventGroupHandle_t xNoWriter;      /* brlockNO_WRITER_BIT set while ulWriter is not raised. */
+        StaticSemaphore_t xWriterMutexBuffer;
+        StaticEventGroup_t xNoWriterBuffer;
+
+        /* Statistics, not reset by the lock. */
+        uint32_t ulReadRetries;            /* Readers that stepped back for a writer. */
+        uint32_t ulWriterWaits;            /* Times a writer waited for a slot to empty. */
+    } BigReaderLock_t;
+
+    void vBigReaderLockInit( BigReaderLock_t * pxLock,
+                             UBaseType_t uxSlotCount );
+    void vBigReaderLockDelete( BigReaderLock_t * pxLock );
+
+/*
+ * Return pdTRUE once the lock is held, or pdFALSE if it could not be obtained
+ * within xTicksToWait or the wait was aborted.
+ */
+    BaseType_t xBigReaderReadLock( BigReaderLock_t * pxLock,
+                                   UBaseType_t uxSlot,
+                                   TickType_t xTicksToWait );
+    void vBigReaderReadUnlock( BigReaderLock_t * pxLock,
+                               UBaseType_t uxSlot );
+    BaseType_t xBigReaderWriteLock( BigReaderLock_t * pxLock,
+                                    TickType_t xTicksToWait );
+    void vBigReaderWriteUnlock( BigReaderLock_t * pxLock );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* BIG_READER_LOCK_H */
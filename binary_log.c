@@ -0,0 +1,567 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Deferred formatting of log messages - see binary_log.h.
+*----------------------------------------------------------*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Local includes. */
+#include "binary_log.h"
+
+/* Longest flags, width or precision of a conversion, and longest string
+ * argument. */
+#define binlogMAX_FIELD_LENGTH     ( 15U )
+#define binlogMAX_STRING_LENGTH    ( 255U )
+
+typedef enum
+{
+    eArgNone = 0, /* %% and %n, or an unknown conversion. */
+    eArgInt,      /* int and smaller, characters. */
+    eArgLong,     /* 8 byte integers. */
+    eArgDouble,
+    eArgPointer,
+    eArgString
+} ArgClass_t;
+
+/* One conversion of a format string, as parsed by both sides. */
+typedef struct ConversionSpec
+{
+    char cFlags[ binlogMAX_FIELD_LENGTH + 1 ];
+    char cWidth[ binlogMAX_FIELD_LENGTH + 1 ];     /* "*" when an argument. */
+    char cPrecision[ binlogMAX_FIELD_LENGTH + 1 ]; /* Without the '.', "*" when an argument. */
+    int iHasPrecision;
+    char cLength[ 3 ];
+    char cConversion;
+    ArgClass_t xClass;
+} ConversionSpec_t;
+
+/*-----------------------------------------------------------*/
+
+static const char * prvParseField( const char * pc,
+                                   const char * pcAccepted,
+                                   char * pcField )
+{
+    size_t xLength = 0;
+
+    while( ( *pc != '\0' ) && ( strchr( pcAccepted, *pc ) != NULL ) )
+    {
+        if( xLength < binlogMAX_FIELD_LENGTH )
+        {
+            pcField[ xLength++ ] = *pc;
+        }
+
+        pc++;
+    }
+
+    pcField[ xLength ] = '\0';
+
+    return pc;
+}
+/*-----------------------------------------------------------*/
+
+/* pc follows the '%'.  Returns what follows the conversion. */
+static const char * prvParseSpec( const char * pc,
+                                  ConversionSpec_t * pxSpec )
+{
+    size_t xLength = 0;
+
+    memset( pxSpec, 0, sizeof( *pxSpec ) );
+
+    pc = prvParseField( pc, "-+ #0'", pxSpec->cFlags );
+
+    if( *pc == '*' )
+    {
+        strcpy( pxSpec->cWidth, "*" );
+        pc++;
+    }
+    else
+    {
+        pc = prvParseField( pc, "0123456789", pxSpec->cWidth );
+    }
+
+    if( *pc == '.' )
+    {
+        pxSpec->iHasPrecision = 1;
+        pc++;
+
+        if( *pc == '*' )
+        {
+            strcpy( pxSpec->cPrecision, "*" );
+            pc++;
+        }
+        else
+        {
+            pc = prvParseField( pc, "0123456789", pxSpec->cPrecision );
+        }
+    }
+
+    while( ( *pc != '\0' ) && ( strchr( "hljztLq", *pc ) != NULL ) )
+    {
+        if( xLength < sizeof( pxSpec->cLength ) - 1 )
+        {
+            pxSpec->cLength[ xLength++ ] = *pc;
+        }
+
+        pc++;
+    }
+
+    pxSpec->cConversion = *pc;
+
+    if( *pc == '\0' )
+    {
+        return pc;
+    }
+
+    switch( *pc )
+    {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+
+            /* h and hh are promoted to int. */
+            pxSpec->xClass = ( ( pxSpec->cLength[ 0 ] == '\0' ) || ( pxSpec->cLength[ 0 ] == 'h' ) ) ? eArgInt : eArgLong;
+            break;
+
+        case 'c':
+            pxSpec->xClass = eArgInt;
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            pxSpec->xClass = eArgDouble;
+            break;
+
+        case 'p':
+            pxSpec->xClass = eArgPointer;
+            break;
+
+        case 's':
+            pxSpec->xClass = eArgString;
+            break;
+
+        default:
+            pxSpec->xClass = eArgNone;
+            break;
+    }
+
+    return pc + 1;
+}
+/*-----------------------------------------------------------*/
+
+static int prvPut( uint8_t * pucArguments,
+                   size_t xSize,
+                   size_t * pxUsed,
+                   const void * pvValue,
+                   size_t xLength )
+{
+    if( *pxUsed + xLength > xSize )
+    {
+        return 0;
+    }
+
+    memcpy( &pucArguments[ *pxUsed ], pvValue, xLength );
+    *pxUsed += xLength;
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+size_t xBinaryLogEncode( uint8_t * pucArguments,
+                         size_t xSize,
+                         uint8_t * pucFlags,
+                         const char * pcFormat,
+                         va_list xArguments )
+{
+    ConversionSpec_t xSpec;
+    size_t xUsed = 0;
+    int iFits = 1;
+
+    *pucFlags = 0;
+
+    for( const char * pc = pcFormat; ( *pc != '\0' ) && iFits; )
+    {
+        if( *pc++ != '%' )
+        {
+            continue;
+        }
+
+        pc = prvParseSpec( pc, &xSpec );
+
+        if( xSpec.cConversion == '%' )
+        {
+            continue;
+        }
+
+        if( xSpec.cWidth[ 0 ] == '*' )
+        {
+            int iWidth = va_arg( xArguments, int );
+            iFits = prvPut( pucArguments, xSize, &xUsed, &iWidth, sizeof( int32_t ) );
+        }
+
+        if( iFits && ( xSpec.cPrecision[ 0 ] == '*' ) )
+        {
+            int iPrecision = va_arg( xArguments, int );
+            iFits = prvPut( pucArguments, xSize, &xUsed, &iPrecision, sizeof( int32_t ) );
+        }
+
+        if( !iFits )
+        {
+            break;
+        }
+
+        switch( xSpec.xClass )
+        {
+            case eArgInt:
+               {
+                   int32_t lValue = ( int32_t ) va_arg( xArguments, int );
+                   iFits = prvPut( pucArguments, xSize, &xUsed, &lValue, sizeof( lValue ) );
+                   break;
+               }
+
+            case eArgLong:
+               {
+                   uint64_t ullValue;
+
+                   if( ( xSpec.cLength[ 0 ] == 'l' ) && ( xSpec.cLength[ 1 ] == '\0' ) )
+                   {
+                       ullValue = ( uint64_t ) va_arg( xArguments, long );
+                   }
+                   else if( xSpec.cLength[ 0 ] == 'j' )
+                   {
+                       ullValue = ( uint64_t ) va_arg( xArguments, intmax_t );
+                   }
+                   else if( xSpec.cLength[ 0 ] == 'z' )
+                   {
+                       ullValue = ( uint64_t ) va_arg( xArguments, size_t );
+                   }
+                   else if( xSpec.cLength[ 0 ] == 't' )
+                   {
+                       ullValue = ( uint64_t ) va_arg( xArguments, ptrdiff_t );
+                   }
+                   else
+                   {
+                       ullValue = ( uint64_t ) va_arg( xArguments, long long );
+                   }
+
+                   iFits = prvPut( pucArguments, xSize, &xUsed, &ullValue, sizeof( ullValue ) );
+                   break;
+               }
+
+            case eArgDouble:
+               {
+                   double dValue = ( xSpec.cLength[ 0 ] == 'L' ) ? ( double ) va_arg( xArguments, long double ) :
+                                   va_arg( xArguments, double );
+                   iFits = prvPut( pucArguments, xSize, &xUsed, &dValue, sizeof( dValue ) );
+                   break;
+               }
+
+            case eArgPointer:
+               {
+                   uint64_t ullValue = ( uint64_t ) ( uintptr_t ) va_arg( xArguments, void * );
+                   iFits = prvPut( pucArguments, xSize, &xUsed, &ullValue, sizeof( ullValue ) );
+                   break;
+               }
+
+            case eArgString:
+               {
+                   const char * pcValue = va_arg( xArguments, const char * );
+                   size_t xLength = ( pcValue != NULL ) ? strlen( pcValue ) : 0;
+                   uint8_t ucLength;
+
+                   if( pcValue == NULL )
+                   {
+                       pcValue = "(null)";
+                       xLength = 6;
+                   }
+
+                   /* A string is cut rather than dropped. */
+                   if( xLength > binlogMAX_STRING_LENGTH )
+                   {
+                       xLength = binlogMAX_STRING_LENGTH;
+                   }
+
+                   if( xUsed + 1U + xLength > xSize )
+                   {
+                       xLength = ( xUsed + 1U < xSize ) ? xSize - xUsed - 1U : 0;
+                       *pucFlags |= binlogFLAG_TRUNCATED;
+                   }
+
+                   ucLength = ( uint8_t ) xLength;
+                   iFits = prvPut( pucArguments, xSize, &xUsed, &ucLength, 1 ) &&
+                           prvPut( pucArguments, xSize, &xUsed, pcValue, xLength );
+                   break;
+               }
+
+            case eArgNone:
+            default:
+
+                if( xSpec.cConversion == 'n' )
+                {
+                    ( void ) va_arg( xArguments, void * );
+                }
+
+                break;
+        }
+    }
+
+    if( !iFits )
+    {
+        *pucFlags |= binlogFLAG_TRUNCATED;
+    }
+
+    return xUsed;
+}
+/*-----------------------------------------------------------*/
+
+static int prvGet( const uint8_t * pucArguments,
+                   size_t xLength,
+                   size_t * pxOffset,
+                   void * pvValue,
+                   size_t xSize )
+{
+    if( *pxOffset + xSize > xLength )
+    {
+        return 0;
+    }
+
+    memcpy( pvValue, &pucArguments[ *pxOffset ], xSize );
+    *pxOffset += xSize;
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+/* Rebuilds the conversion with the width and precision arguments in place
+ * of '*', and the length modifier the recorded value is passed with. */
+static int prvGetSpecText( char * pcSpec,
+                           size_t xSize,
+                           const ConversionSpec_t * pxSpec,
+                           const uint8_t * pucArguments,
+                           size_t xLength,
+                           size_t * pxOffset )
+{
+    char cWidth[ binlogMAX_FIELD_LENGTH + 1 ];
+    char cPrecision[ binlogMAX_FIELD_LENGTH + 2 ];
+    int32_t lValue;
+
+    strcpy( cWidth, pxSpec->cWidth );
+    cPrecision[ 0 ] = '\0';
+
+    if( pxSpec->cWidth[ 0 ] == '*' )
+    {
+        if( !prvGet( pucArguments, xLength, pxOffset, &lValue, sizeof( lValue ) ) )
+        {
+            return 0;
+        }
+
+        snprintf( cWidth, sizeof( cWidth ), "%ld", ( long ) lValue );
+    }
+
+    if( pxSpec->iHasPrecision )
+    {
+        if( pxSpec->cPrecision[ 0 ] == '*' )
+        {
+            if( !prvGet( pucArguments, xLength, pxOffset, &lValue, sizeof( lValue ) ) )
+            {
+                return 0;
+            }
+
+            snprintf( cPrecision, sizeof( cPrecision ), ".%ld", ( long ) lValue );
+        }
+        else
+        {
+            snprintf( cPrecision, sizeof( cPrecision ), ".%s", pxSpec->cPrecision );
+        }
+    }
+
+    snprintf( pcSpec, xSize, "%%%s%s%s%s%c", pxSpec->cFlags, cWidth, cPrecision,
+              ( pxSpec->xClass == eArgLong ) ? "ll" : "", pxSpec->cConversion );
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+size_t xBinaryLogFormat( char * pcOut,
+                         size_t xSize,
+                         const char * pcFormat,
+                         const uint8_t * pucArguments,
+                         size_t xLength,
+                         uint8_t ucFlags )
+{
+    ConversionSpec_t xSpec;
+    char cSpec[ 4 * binlogMAX_FIELD_LENGTH ];
+    size_t xOffset = 0;
+    size_t xUsed = 0;
+
+    ( void ) ucFlags;
+
+    if( xSize == 0 )
+    {
+        return 0;
+    }
+
+    for( const char * pc = pcFormat; ( *pc != '\0' ) && ( xUsed + 1U < xSize ); )
+    {
+        const char * pcStart = pc;
+        int iWritten = 0;
+
+        if( *pc != '%' )
+        {
+            pcOut[ xUsed++ ] = *pc++;
+            continue;
+        }
+
+        pc = prvParseSpec( pc + 1, &xSpec );
+
+        if( ( xSpec.cConversion == '%' ) || ( xSpec.cConversion == 'n' ) )
+        {
+            iWritten = ( xSpec.cConversion == '%' ) ? snprintf( &pcOut[ xUsed ], xSize - xUsed, "%%" ) : 0;
+        }
+        else if( xSpec.xClass == eArgNone )
+        {
+            /* Not a conversion - copied as is. */
+            iWritten = snprintf( &pcOut[ xUsed ], xSize - xUsed, "%.*s", ( int ) ( pc - pcStart ), pcStart );
+        }
+        else if( !prvGetSpecText( cSpec, sizeof( cSpec ), &xSpec, pucArguments, xLength, &xOffset ) )
+        {
+            iWritten = snprintf( &pcOut[ xUsed ], xSize - xUsed, "?" );
+        }
+        else
+        {
+            int32_t lValue;
+            uint64_t ullValue;
+            double dValue;
+            uint8_t ucStringLength;
+            char cString[ binlogMAX_STRING_LENGTH + 1 ];
+
+            switch( xSpec.xClass )
+            {
+                case eArgInt:
+                    iWritten = prvGet( pucArguments, xLength, &xOffset, &lValue, sizeof( lValue ) ) ?
+                               snprintf( &pcOut[ xUsed ], xSize - xUsed, cSpec, ( int ) lValue ) :
+                               snprintf( &pcOut[ xUsed ], xSize - xUsed, "?" );
+                    break;
+
+                case eArgLong:
+                    iWritten = prvGet( pucArguments, xLength, &xOffset, &ullValue, sizeof( ullValue ) ) ?
+                               snprintf( &pcOut[ xUsed ], xSize - xUsed, cSpec, ( unsigned long long ) ullValue ) :
+                               snprintf( &pcOut[ xUsed ], xSize - xUsed, "?" );
+                    break;
+
+                case eArgDouble:
+                    iWritten = prvGet( pucArguments, xLength, &xOffset, &dValue, sizeof( dValue ) ) ?
+                               snprintf( &pcOut[ xUsed ], xSize - xUsed, cSpec, dValue ) :
+                               snprintf( &pcOut[ xUsed ], xSize - xUsed, "?" );
+                    break;
+
+                case eArgPointer:
+                    iWritten = prvGet( pucArguments, xLength, &xOffset, &ullValue, sizeof( ullValue ) ) ?
+                               snprintf( &pcOut[ xUsed ], xSize - xUsed, cSpec, ( void * ) ( uintptr_t ) ullValue ) :
+                               snprintf( &pcOut[ xUsed ], xSize - xUsed, "?" );
+                    break;
+
+                case eArgString:
+                default:
+
+                    if( prvGet( pucArguments, xLength, &xOffset, &ucStringLength, 1 ) &&
+                        prvGet( pucArguments, xLength, &xOffset, cString, ucStringLength ) )
+                    {
+                        cString[ ucStringLength ] = '\0';
+                        iWritten = snprintf( &pcOut[ xUsed ], xSize - xUsed, cSpec, cString );
+                    }
+                    else
+                    {
+                        iWritten = snprintf( &pcOut[ xUsed ], xSize - xUsed, "?" );
+                    }
+
+                    break;
+            }
+        }
+
+        if( iWritten > 0 )
+        {
+            xUsed += ( ( size_t ) iWritten < xSize - xUsed ) ? ( size_t ) iWritten : xSize - xUsed - 1U;
+        }
+    }
+
+    pcOut[ xUsed ] = '\0';
+
+    return xUsed;
+}
+/*-----------------------------------------------------------*/
+
+int iBinaryLogWriteFormat( FILE * pxFile,
+                           uint64_t ullFormat,
+                           const char * pcFormat )
+{
+    uint8_t ucType = binlogTYPE_FORMAT;
+    uint16_t usLength = ( uint16_t ) strnlen( pcFormat, UINT16_MAX );
+
+    if( ( fwrite( &ucType, sizeof( ucType ), 1, pxFile ) != 1 ) ||
+        ( fwrite( &ullFormat, sizeof( ullFormat ), 1, pxFile ) != 1 ) ||
+        ( fwrite( &usLength, sizeof( usLength ), 1, pxFile ) != 1 ) ||
+        ( fwrite( pcFormat, 1, usLength, pxFile ) != usLength ) )
+    {
+        return EOF;
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+int iBinaryLogWriteMessage( FILE * pxFile,
+                            const BinaryLogHeader_t * pxHeader,
+                            const uint8_t * pucArguments )
+{
+    uint8_t ucType = binlogTYPE_MESSAGE;
+
+    if( ( fwrite( &ucType, sizeof( ucType ), 1, pxFile ) != 1 ) ||
+        ( fwrite( &pxHeader->ullTimestamp, sizeof( pxHeader->ullTimestamp ), 1, pxFile ) != 1 ) ||
+        ( fwrite( &pxHeader->ullFormat, sizeof( pxHeader->ullFormat ), 1, pxFile ) != 1 ) ||
+        ( fwrite( &pxHeader->ullTask, sizeof( pxHeader->ullTask ), 1, pxFile ) != 1 ) ||
+        ( fwrite( &pxHeader->ucFlags, sizeof( pxHeader->ucFlags ), 1, pxFile ) != 1 ) ||
+        ( fwrite( &pxHeader->usLength, sizeof( pxHeader->usLength ), 1, pxFile ) != 1 ) ||
+        ( fwrite( pucArguments, 1, pxHeader->usLength, pxFile ) != pxHeader->usLength ) )
+    {
+        return EOF;
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
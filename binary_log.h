@@ -0,0 +1,117 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef BINARY_LOG_H
+    #define BINARY_LOG_H
+
+    #include <stdarg.h>
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <stdio.h>
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Deferred formatting of printf style log messages.
+*
+* xBinaryLogEncode() records the raw arguments of a message - walking the
+* format string only to learn their types - and xBinaryLogFormat() formats
+* them later, from the same format string, one conversion at a time.  The
+* format string itself is not copied: a message is identified by the address
+* of its format, which must be a string literal or otherwise outlive the
+* message.  Strings passed with %s are copied, up to 255 characters.
+*
+* Arguments are packed without padding: 4 bytes for int sized integers and
+* characters, 8 bytes for long, long long, size_t, intmax_t, ptrdiff_t,
+* pointers and floating point values (long double is stored as a double),
+* and a length byte followed by the characters for strings.  %n is not
+* supported and produces nothing.
+*
+* This file does not depend on FreeRTOS, so that tools/console_decode.c can
+* decode the binary log dumped by console.c offline.  The dump starts with
+* binlogMAGIC, followed by records in the byte order of the machine that
+* wrote it:
+* - 'F' id:u64 length:u16 characters - the format string of id, written
+*   before the first message that uses it;
+* - 'M' timestamp:u64 id:u64 task:u64 flags:u8 length:u16 arguments - a
+*   message, timestamp in ns whatever the resolution of the run time
+*   counter - see ullGetRunTimeNs().
+*----------------------------------------------------------*/
+
+    #define binlogMAGIC            "FRTBLOG1"
+    #define binlogMAGIC_LENGTH     ( 8U )
+    #define binlogTYPE_FORMAT      ( ( uint8_t ) 'F' )
+    #define binlogTYPE_MESSAGE     ( ( uint8_t ) 'M' )
+
+/* The arguments did not all fit, the missing ones are formatted as "?". */
+    #define binlogFLAG_TRUNCATED   ( 0x01U )
+
+    typedef struct BinaryLogHeader
+    {
+        uint64_t ullTimestamp;
+        uint64_t ullFormat;   /* Address of the format string. */
+        uint64_t ullTask;     /* Handle of the logging task, 0 for none. */
+        uint8_t ucFlags;
+        uint16_t usLength;    /* Of the arguments. */
+    } BinaryLogHeader_t;
+
+/*
+ * Packs the arguments of pcFormat into pucArguments, at most xSize bytes.
+ * Returns the number of bytes used, and sets binlogFLAG_TRUNCATED in
+ * *pucFlags if some did not fit.
+ */
+    size_t xBinaryLogEncode( uint8_t * pucArguments,
+                             size_t xSize,
+                             uint8_t * pucFlags,
+                             const char * pcFormat,
+                             va_list xArguments );
+
+/*
+ * Formats pcFormat with the packed arguments into pcOut, which is always
+ * terminated.  Returns the length of the text written.
+ */
+    size_t xBinaryLogFormat( char * pcOut,
+                             size_t xSize,
+                             const char * pcFormat,
+                             const uint8_t * pucArguments,
+                             size_t xLength,
+                             uint8_t ucFlags );
+
+/* Dump records - return 0 on success, like fflush(). */
+    int iBinaryLogWriteFormat( FILE * pxFile,
+                               uint64_t ullFormat,
+                               const char * pcFormat );
+    int iBinaryLogWriteMessage( FILE * pxFile,
+                                const BinaryLogHeader_t * pxHeader,
+                                const uint8_t * pucArguments );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* BINARY_LOG_H */
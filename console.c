@@ -25,22 +25,672 @@
  */
 
 /*-----------------------------------------------------------
-* Example console I/O wrappers.
+* Example console I/O wrappers - see console.h.
 *----------------------------------------------------------*/
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <FreeRTOS.h>
+#include <task.h>
 #include <semphr.h>
 
+#include "console.h"
+#include "binary_log.h"
+#include "mmap_log.h"
+#include "run_time_stats.h"
+#include "sem_profiler.h"
+
+/* The ring: consoleRING_RECORDS slots of consoleRECORD_SIZE characters.  The
+ * flusher is woken up every consoleFLUSH_PERIOD, or as soon as the ring is
+ * half full, and writes up to consoleBATCH_SIZE characters at a time. */
+#define consoleRING_RECORDS       ( 256U )
+#define consoleRECORD_SIZE        ( 192U )
+#define consoleBATCH_SIZE         ( 4096U )
+#define consoleFLUSH_PERIOD       pdMS_TO_TICKS( 10UL )
+#define consoleFLUSHER_PRIORITY   ( tskIDLE_PRIORITY + 1 )
+#define consoleFLUSHER_STACK_SIZE ( 1000UL )
+
+/* A binary record formats to at most consoleMAX_TEXT characters.  Up to
+ * consoleMAX_FORMATS format strings are remembered as dumped already. */
+#define consoleMAX_TEXT           ( 512U )
+#define consoleMAX_FORMATS        ( 256U )
+#define consoleBINARY_RECORD      ( 0x80000000UL )
+
+/* The first consoleTASK_BUFFERS tasks that print get a buffer of their own,
+ * of consoleTASK_BUFFER_SIZE bytes (a power of 2), found through their
+ * thread local storage pointer consoleTLS_INDEX.  The others use the ring. */
+#define consoleTASK_BUFFERS       ( 64U )
+#define consoleTASK_BUFFER_SIZE   ( 1024U )
+#define consoleTLS_INDEX          ( 0 )
+
+/* A slot is free for the producer claiming position n when its sequence is
+ * n, and holds a record for the flusher when it is n + 1. */
+typedef struct ConsoleRecord
+{
+    uint32_t ulSequence;
+    uint32_t ulLength;
+    char cText[ consoleRECORD_SIZE ];
+} ConsoleRecord_t;
+
+/* Records of one task, each a length word followed by the record, in a byte
+ * ring only written by xOwner and only read by the flusher - no lock, no
+ * read-modify-write.  ulHead and ulTail run freely. */
+typedef struct ConsoleTaskBuffer
+{
+    TaskHandle_t xOwner; /* NULL while free. */
+    uint32_t ulHead;     /* Written by xOwner. */
+    uint32_t ulTail;     /* Written by the flusher. */
+    uint8_t ucData[ consoleTASK_BUFFER_SIZE ];
+} ConsoleTaskBuffer_t;
+
 SemaphoreHandle_t xStdioMutex;
 StaticSemaphore_t xStdioMutexBuffer;
 
+static ConsoleRecord_t xRing[ consoleRING_RECORDS ];
+static uint32_t ulHead = 0; /* Next position to claim. */
+static uint32_t ulTail = 0; /* Next position to write out, flusher only. */
+static char cBatch[ consoleBATCH_SIZE ];
+static ConsoleMode_t xConsoleMode = eConsoleDrop;
+static ConsoleStats_t xStats;
+static TaskHandle_t xFlusher = NULL;
+static SemaphoreHandle_t xSpace = NULL; /* Given after each batch. */
+static StaticSemaphore_t xSpaceBuffer;
+static FILE * pxBinaryFile = NULL;
+static uint64_t ullDumpedFormats[ consoleMAX_FORMATS ];
+static MmapLog_t xLogFile; /* Replaces stdout once open. */
+
+static ConsoleTaskBuffer_t xTaskBuffers[ consoleTASK_BUFFERS ];
+static BaseType_t xUseTaskBuffers = pdTRUE;
+static BaseType_t xBuffersWanted = pdFALSE; /* A task found none free. */
+static uint32_t ulReclaims = 0;             /* Passes that freed buffers. */
+
+static const char * const pcModeNames[] =
+{
+    [ eConsoleDrop ]  = "drop",
+    [ eConsoleBlock ] = "block",
+    [ eConsoleSync ]   = "sync",
+    [ eConsoleBinary ] = "binary"
+};
+
+static void prvFlusherTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
 void console_init( void )
 {
     xStdioMutex = xSemaphoreCreateMutexStatic( &xStdioMutexBuffer );
+    vSemProfilerRegister( xStdioMutex, "xStdioMutex" );
+    xSpace = xSemaphoreCreateBinaryStatic( &xSpaceBuffer );
+
+    for( uint32_t ulSlot = 0; ulSlot < consoleRING_RECORDS; ulSlot++ )
+    {
+        xRing[ ulSlot ].ulSequence = ulSlot;
+    }
+
+    xTaskCreate( prvFlusherTask, "Console", consoleFLUSHER_STACK_SIZE, NULL, consoleFLUSHER_PRIORITY, &xFlusher );
+}
+/*-----------------------------------------------------------*/
+
+void console_set_mode( ConsoleMode_t xMode )
+{
+    xConsoleMode = xMode;
+}
+/*-----------------------------------------------------------*/
+
+void console_set_task_buffers( BaseType_t xEnabled )
+{
+    xUseTaskBuffers = xEnabled;
+}
+/*-----------------------------------------------------------*/
+
+const char * console_mode_name( ConsoleMode_t xMode )
+{
+    return ( xMode < eConsoleModeCount ) ? pcModeNames[ xMode ] : "?";
 }
+/*-----------------------------------------------------------*/
+
+int console_set_binary_file( const char * pcPath )
+{
+    pxBinaryFile = fopen( pcPath, "wb" );
+
+    if( ( pxBinaryFile == NULL ) || ( fwrite( binlogMAGIC, 1, binlogMAGIC_LENGTH, pxBinaryFile ) != binlogMAGIC_LENGTH ) )
+    {
+        return -1;
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+int console_set_log_file( const char * pcPath,
+                          size_t xSize )
+{
+    return iMmapLogOpen( &xLogFile, pcPath, xSize );
+}
+/*-----------------------------------------------------------*/
+
+/* Takes xStdioMutex, accounting for the time spent waiting for it. */
+static void prvLockStdio( void )
+{
+    unsigned long ulStart = ulGetRunTimeCounterValue();
+
+    xSemaphoreTake( xStdioMutex, portMAX_DELAY );
+
+    __atomic_add_fetch( &xStats.ullLockWait, ( uint64_t ) ( ulGetRunTimeCounterValue() - ulStart ), __ATOMIC_RELAXED );
+    __atomic_add_fetch( &xStats.ulLocks, 1U, __ATOMIC_RELAXED );
+}
+/*-----------------------------------------------------------*/
+
+/* Dumps the format string of a message the first time it is seen - or every
+ * time once consoleMAX_FORMATS are known. */
+static void prvDumpFormat( uint64_t ullFormat )
+{
+    uint32_t ulSlot = ( uint32_t ) ( ( ullFormat >> 3 ) % consoleMAX_FORMATS );
+
+    for( uint32_t ulProbe = 0; ulProbe < consoleMAX_FORMATS; ulProbe++ )
+    {
+        uint64_t * pullKnown = &ullDumpedFormats[ ( ulSlot + ulProbe ) % consoleMAX_FORMATS ];
+
+        if( *pullKnown == ullFormat )
+        {
+            return;
+        }
+
+        if( *pullKnown == 0 )
+        {
+            *pullKnown = ullFormat;
+            break;
+        }
+    }
+
+    iBinaryLogWriteFormat( pxBinaryFile, ullFormat, ( const char * ) ( uintptr_t ) ullFormat );
+}
+/*-----------------------------------------------------------*/
+
+/* The only place the console output leaves the program from. */
+static size_t prvWriteBatch( size_t xBatched )
+{
+    if( ( xBatched > 0 ) && ( xLogFile.pxHeader != NULL ) )
+    {
+        vMmapLogWrite( &xLogFile, cBatch, xBatched );
+    }
+    else if( xBatched > 0 )
+    {
+        fwrite( cBatch, 1, xBatched, stdout );
+        fflush( stdout );
+        __atomic_add_fetch( &xStats.ulWrites, 1U, __ATOMIC_RELAXED );
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+/* Adds a record to cBatch - formatting it if it is a binary one - or dumps
+ * it, and returns the new length of the batch. */
+static size_t prvDrainRecord( const char * pcRecord,
+                              uint32_t ulLength,
+                              size_t xBatched )
+{
+    if( xBatched + consoleMAX_TEXT > consoleBATCH_SIZE )
+    {
+        xBatched = prvWriteBatch( xBatched );
+    }
+
+    if( ( ulLength & consoleBINARY_RECORD ) == 0 )
+    {
+        memcpy( &cBatch[ xBatched ], pcRecord, ulLength );
+        return xBatched + ulLength;
+    }
+
+    BinaryLogHeader_t xHeader;
+    const uint8_t * pucArguments = ( const uint8_t * ) &pcRecord[ sizeof( xHeader ) ];
+
+    memcpy( &xHeader, pcRecord, sizeof( xHeader ) );
+
+    if( pxBinaryFile != NULL )
+    {
+        prvDumpFormat( xHeader.ullFormat );
+        iBinaryLogWriteMessage( pxBinaryFile, &xHeader, pucArguments );
+        return xBatched;
+    }
+
+    return xBatched + xBinaryLogFormat( &cBatch[ xBatched ], consoleBATCH_SIZE - xBatched,
+                                        ( const char * ) ( uintptr_t ) xHeader.ullFormat,
+                                        pucArguments, xHeader.usLength, xHeader.ucFlags );
+}
+/*-----------------------------------------------------------*/
+
+/* Copies to and from a task buffer, across its end if need be. */
+static void prvCopyIn( ConsoleTaskBuffer_t * pxBuffer,
+                       uint32_t ulPosition,
+                       const void * pvData,
+                       uint32_t ulSize )
+{
+    uint32_t ulOffset = ulPosition % consoleTASK_BUFFER_SIZE;
+    uint32_t ulFirst = ( ulSize < consoleTASK_BUFFER_SIZE - ulOffset ) ? ulSize : consoleTASK_BUFFER_SIZE - ulOffset;
+
+    memcpy( &pxBuffer->ucData[ ulOffset ], pvData, ulFirst );
+    memcpy( pxBuffer->ucData, ( const uint8_t * ) pvData + ulFirst, ulSize - ulFirst );
+}
+
+static void prvCopyOut( const ConsoleTaskBuffer_t * pxBuffer,
+                        uint32_t ulPosition,
+                        void * pvData,
+                        uint32_t ulSize )
+{
+    uint32_t ulOffset = ulPosition % consoleTASK_BUFFER_SIZE;
+    uint32_t ulFirst = ( ulSize < consoleTASK_BUFFER_SIZE - ulOffset ) ? ulSize : consoleTASK_BUFFER_SIZE - ulOffset;
+
+    memcpy( pvData, &pxBuffer->ucData[ ulOffset ], ulFirst );
+    memcpy( ( uint8_t * ) pvData + ulFirst, pxBuffer->ucData, ulSize - ulFirst );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvDrainTaskBuffer( ConsoleTaskBuffer_t * pxBuffer,
+                                  size_t xBatched )
+{
+    /* Only reached through prvDrain() - from the flusher, console_flush() or
+     * a direct print in any task - which holds xStdioMutex while the
+     * scheduler runs, and otherwise runs in the only thread left, before
+     * the scheduler starts or after it ends.  Either way one caller at a
+     * time uses cRecord and reads the task buffers. */
+    static char cRecord[ consoleRECORD_SIZE ];
+    uint32_t ulPosition = pxBuffer->ulTail;
+    uint32_t ulEnd = __atomic_load_n( &pxBuffer->ulHead, __ATOMIC_ACQUIRE );
+
+    while( ulPosition != ulEnd )
+    {
+        uint32_t ulLength;
+        uint32_t ulSize;
+
+        prvCopyOut( pxBuffer, ulPosition, &ulLength, sizeof( ulLength ) );
+        ulSize = ulLength & ~consoleBINARY_RECORD;
+        prvCopyOut( pxBuffer, ulPosition + sizeof( ulLength ), cRecord, ulSize );
+        ulPosition += sizeof( ulLength ) + ulSize;
+
+        /* The copy is taken - the owner can reuse the space already. */
+        __atomic_store_n( &pxBuffer->ulTail, ulPosition, __ATOMIC_RELEASE );
+        xBatched = prvDrainRecord( cRecord, ulLength, xBatched );
+    }
+
+    return xBatched;
+}
+/*-----------------------------------------------------------*/
+
+/* Frees the (drained) buffers of the tasks that were deleted.  A task's
+ * handle cannot be checked once it is gone, hence the list of those that
+ * still exist. */
+static void prvReclaimTaskBuffers( void )
+{
+    UBaseType_t uxTasks = uxTaskGetNumberOfTasks();
+    TaskStatus_t * pxTasks = pvPortMalloc( uxTasks * sizeof( TaskStatus_t ) );
+    BaseType_t xReclaimed = pdFALSE;
+
+    if( pxTasks == NULL )
+    {
+        return;
+    }
+
+    /* No task can be created, nor adopt a buffer, while they are looked at. */
+    vTaskSuspendAll();
+    __atomic_store_n( &xBuffersWanted, pdFALSE, __ATOMIC_RELAXED );
+    uxTasks = uxTaskGetSystemState( pxTasks, uxTasks, NULL );
+
+    for( uint32_t ulBuffer = 0; ulBuffer < consoleTASK_BUFFERS; ulBuffer++ )
+    {
+        ConsoleTaskBuffer_t * pxBuffer = &xTaskBuffers[ ulBuffer ];
+        TaskHandle_t xOwner = __atomic_load_n( &pxBuffer->xOwner, __ATOMIC_ACQUIRE );
+        UBaseType_t x = 0;
+
+        if( ( xOwner == NULL ) || ( pxBuffer->ulHead != pxBuffer->ulTail ) )
+        {
+            continue;
+        }
+
+        while( ( x < uxTasks ) && ( pxTasks[ x ].xHandle != xOwner ) )
+        {
+            x++;
+        }
+
+        if( x == uxTasks )
+        {
+            pxBuffer->ulHead = 0;
+            pxBuffer->ulTail = 0;
+            __atomic_store_n( &pxBuffer->xOwner, NULL, __ATOMIC_RELEASE );
+            xReclaimed = pdTRUE;
+        }
+    }
+
+    ( void ) xTaskResumeAll();
+    vPortFree( pxTasks );
+
+    if( xReclaimed == pdTRUE )
+    {
+        __atomic_add_fetch( &ulReclaims, 1U, __ATOMIC_RELEASE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Writes out the records in the ring, in order, then those of each task
+ * buffer, batched into cBatch.  Stops at a slot of the ring that is claimed
+ * but not filled in yet. */
+static void prvDrain( void )
+{
+    BaseType_t xLocked = ( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING );
+    size_t xBatched = 0;
+
+    if( xLocked == pdTRUE )
+    {
+        prvLockStdio();
+    }
+
+    for( ; ; )
+    {
+        ConsoleRecord_t * pxRecord = &xRing[ ulTail % consoleRING_RECORDS ];
+
+        if( __atomic_load_n( &pxRecord->ulSequence, __ATOMIC_ACQUIRE ) != ulTail + 1U )
+        {
+            break;
+        }
+
+        xBatched = prvDrainRecord( pxRecord->cText, pxRecord->ulLength, xBatched );
+
+        /* Free for the producer that will claim it a lap later. */
+        __atomic_store_n( &pxRecord->ulSequence, ulTail + consoleRING_RECORDS, __ATOMIC_RELEASE );
+        __atomic_store_n( &ulTail, ulTail + 1U, __ATOMIC_RELAXED );
+    }
+
+    for( uint32_t ulBuffer = 0; ulBuffer < consoleTASK_BUFFERS; ulBuffer++ )
+    {
+        xBatched = prvDrainTaskBuffer( &xTaskBuffers[ ulBuffer ], xBatched );
+    }
+
+    prvWriteBatch( xBatched );
+
+    if( pxBinaryFile != NULL )
+    {
+        fflush( pxBinaryFile );
+    }
+
+    if( xLocked == pdTRUE )
+    {
+        if( __atomic_load_n( &xBuffersWanted, __ATOMIC_RELAXED ) == pdTRUE )
+        {
+            prvReclaimTaskBuffers();
+        }
+
+        xSemaphoreGive( xStdioMutex );
+        xSemaphoreGive( xSpace );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Returns the claimed slot, or NULL if the ring is full. */
+static ConsoleRecord_t * prvClaim( uint32_t * pulPosition )
+{
+    uint32_t ulPosition = __atomic_load_n( &ulHead, __ATOMIC_RELAXED );
+
+    for( ; ; )
+    {
+        ConsoleRecord_t * pxRecord = &xRing[ ulPosition % consoleRING_RECORDS ];
+        int32_t lLag = ( int32_t ) ( __atomic_load_n( &pxRecord->ulSequence, __ATOMIC_ACQUIRE ) - ulPosition );
+
+        if( lLag == 0 )
+        {
+            /* On failure ulPosition is reloaded with the current head. */
+            if( __atomic_compare_exchange_n( &ulHead, &ulPosition, ulPosition + 1U, pdFALSE,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+            {
+                *pulPosition = ulPosition;
+                return pxRecord;
+            }
+        }
+        else if( lLag < 0 )
+        {
+            /* Still holds the record of the previous lap. */
+            return NULL;
+        }
+        else
+        {
+            ulPosition = __atomic_load_n( &ulHead, __ATOMIC_RELAXED );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Hands the filled in record over to the flusher. */
+static void prvPublish( ConsoleRecord_t * pxRecord,
+                        uint32_t ulPosition,
+                        uint32_t ulLength )
+{
+    pxRecord->ulLength = ulLength;
+    __atomic_store_n( &pxRecord->ulSequence, ulPosition + 1U, __ATOMIC_RELEASE );
+    __atomic_add_fetch( &xStats.ulRecords, 1U, __ATOMIC_RELAXED );
+
+    /* The flusher also runs every consoleFLUSH_PERIOD - only hurry it up
+     * when the ring fills. */
+    if( ( ulPosition + 1U - __atomic_load_n( &ulTail, __ATOMIC_RELAXED ) ) == ( consoleRING_RECORDS / 2U ) )
+    {
+        xTaskNotifyGive( xFlusher );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Returns the buffer of the calling task, claiming one the first time, or
+ * NULL if none was free.  A task that found none only looks again once the
+ * flusher reclaimed some - its storage pointer then holds ( pass << 1 ) | 1. */
+static ConsoleTaskBuffer_t * prvTaskBuffer( void )
+{
+    void * pvBuffer = pvTaskGetThreadLocalStoragePointer( NULL, consoleTLS_INDEX );
+    uint32_t ulPass = __atomic_load_n( &ulReclaims, __ATOMIC_ACQUIRE );
+    void * pvNoBuffer = ( void * ) ( ( ( uintptr_t ) ulPass << 1 ) | 1U );
+    TaskHandle_t xSelf;
+
+    if( ( ( ( uintptr_t ) pvBuffer & 1U ) == 0U ) && ( pvBuffer != NULL ) )
+    {
+        return pvBuffer;
+    }
+
+    if( pvBuffer == pvNoBuffer )
+    {
+        return NULL;
+    }
+
+    xSelf = xTaskGetCurrentTaskHandle();
+
+    for( uint32_t ulBuffer = 0; ulBuffer < consoleTASK_BUFFERS; ulBuffer++ )
+    {
+        ConsoleTaskBuffer_t * pxBuffer = &xTaskBuffers[ ulBuffer ];
+        TaskHandle_t xOwner = NULL;
+
+        /* A buffer still owned by the handle is that of a deleted task whose
+         * control block was reused - its records are older, keep them first. */
+        if( __atomic_compare_exchange_n( &pxBuffer->xOwner, &xOwner, xSelf, pdFALSE,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) ||
+            ( xOwner == xSelf ) )
+        {
+            vTaskSetThreadLocalStoragePointer( NULL, consoleTLS_INDEX, pxBuffer );
+            return pxBuffer;
+        }
+    }
+
+    __atomic_store_n( &xBuffersWanted, pdTRUE, __ATOMIC_RELAXED );
+    vTaskSetThreadLocalStoragePointer( NULL, consoleTLS_INDEX, pvNoBuffer );
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* Appends a record to the buffer of the calling task, if there is room. */
+static BaseType_t prvBufferPut( ConsoleTaskBuffer_t * pxBuffer,
+                                const char * pcRecord,
+                                uint32_t ulLength )
+{
+    uint32_t ulSize = sizeof( ulLength ) + ( ulLength & ~consoleBINARY_RECORD );
+    uint32_t ulPosition = pxBuffer->ulHead;
+    uint32_t ulUsed = ulPosition - __atomic_load_n( &pxBuffer->ulTail, __ATOMIC_ACQUIRE );
+
+    if( ulUsed + ulSize > consoleTASK_BUFFER_SIZE )
+    {
+        return pdFALSE;
+    }
+
+    prvCopyIn( pxBuffer, ulPosition, &ulLength, sizeof( ulLength ) );
+    prvCopyIn( pxBuffer, ulPosition + sizeof( ulLength ), pcRecord, ulSize - sizeof( ulLength ) );
+    __atomic_store_n( &pxBuffer->ulHead, ulPosition + ulSize, __ATOMIC_RELEASE );
+    __atomic_add_fetch( &xStats.ulRecords, 1U, __ATOMIC_RELAXED );
+
+    if( ( ulUsed < consoleTASK_BUFFER_SIZE / 2U ) && ( ulUsed + ulSize >= consoleTASK_BUFFER_SIZE / 2U ) )
+    {
+        xTaskNotifyGive( xFlusher );
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/* Called when the ring, or the buffer of the task, is full.  Returns pdFALSE
+ * if the record is to be dropped, pdTRUE to try again. */
+static BaseType_t prvWaitForSpace( void )
+{
+    if( xConsoleMode != eConsoleBlock )
+    {
+        __atomic_add_fetch( &xStats.ulDropped, 1U, __ATOMIC_RELAXED );
+        return pdFALSE;
+    }
+
+    __atomic_add_fetch( &xStats.ulBlocked, 1U, __ATOMIC_RELAXED );
+    xTaskNotifyGive( xFlusher );
+    xSemaphoreTake( xSpace, consoleFLUSH_PERIOD );
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/* Formats - or encodes, in binary mode - a message into pcRecord, which is
+ * consoleRECORD_SIZE long, and returns the length of the record. */
+static uint32_t prvFormatRecord( char * pcRecord,
+                                 const char * fmt,
+                                 va_list vargs )
+{
+    if( xConsoleMode == eConsoleBinary )
+    {
+        BinaryLogHeader_t xHeader;
+
+        xHeader.ullTimestamp = ullGetRunTimeNs();
+        xHeader.ullFormat = ( uint64_t ) ( uintptr_t ) fmt;
+        xHeader.ullTask = ( uint64_t ) ( uintptr_t ) xTaskGetCurrentTaskHandle();
+        xHeader.usLength = ( uint16_t ) xBinaryLogEncode( ( uint8_t * ) &pcRecord[ sizeof( xHeader ) ],
+                                                          consoleRECORD_SIZE - sizeof( xHeader ),
+                                                          &xHeader.ucFlags, fmt, vargs );
+
+        if( ( xHeader.ucFlags & binlogFLAG_TRUNCATED ) != 0 )
+        {
+            __atomic_add_fetch( &xStats.ulTruncated, 1U, __ATOMIC_RELAXED );
+        }
+
+        memcpy( pcRecord, &xHeader, sizeof( xHeader ) );
+        return ( uint32_t ) ( sizeof( xHeader ) + xHeader.usLength ) | consoleBINARY_RECORD;
+    }
+
+    int iLength = vsnprintf( pcRecord, consoleRECORD_SIZE, fmt, vargs );
+
+    if( iLength < 0 )
+    {
+        iLength = 0;
+    }
+    else if( iLength >= ( int ) consoleRECORD_SIZE )
+    {
+        iLength = consoleRECORD_SIZE - 1;
+        __atomic_add_fetch( &xStats.ulTruncated, 1U, __ATOMIC_RELAXED );
+    }
+
+    return ( uint32_t ) iLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintDirect( const char * fmt,
+                            va_list vargs )
+{
+    BaseType_t xLocked = ( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING );
+
+    /* Keep the order of what was queued before. */
+    prvDrain();
+
+    /* cBatch is only used under xStdioMutex, or by the one thread left. */
+    if( xLocked == pdTRUE )
+    {
+        prvLockStdio();
+    }
+
+    int iLength = vsnprintf( cBatch, consoleBATCH_SIZE, fmt, vargs );
+
+    if( iLength < 0 )
+    {
+        iLength = 0;
+    }
+    else if( iLength >= ( int ) consoleBATCH_SIZE )
+    {
+        iLength = consoleBATCH_SIZE - 1;
+        __atomic_add_fetch( &xStats.ulTruncated, 1U, __ATOMIC_RELAXED );
+    }
+
+    prvWriteBatch( ( size_t ) iLength );
+
+    if( xLocked == pdTRUE )
+    {
+        xSemaphoreGive( xStdioMutex );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void console_vprint( const char * fmt,
+                     va_list vargs )
+{
+    ConsoleTaskBuffer_t * pxBuffer = NULL;
+    ConsoleRecord_t * pxRecord;
+    uint32_t ulPosition;
+
+    if( ( xConsoleMode == eConsoleSync ) || ( xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ) )
+    {
+        prvPrintDirect( fmt, vargs );
+        return;
+    }
+
+    if( xUseTaskBuffers == pdTRUE )
+    {
+        pxBuffer = prvTaskBuffer();
+    }
+
+    if( pxBuffer != NULL )
+    {
+        char cRecord[ consoleRECORD_SIZE ];
+        uint32_t ulLength = prvFormatRecord( cRecord, fmt, vargs );
+
+        while( prvBufferPut( pxBuffer, cRecord, ulLength ) == pdFALSE )
+        {
+            if( prvWaitForSpace() == pdFALSE )
+            {
+                return;
+            }
+        }
+
+        return;
+    }
+
+    while( ( pxRecord = prvClaim( &ulPosition ) ) == NULL )
+    {
+        if( prvWaitForSpace() == pdFALSE )
+        {
+            return;
+        }
+    }
+
+    prvPublish( pxRecord, ulPosition, prvFormatRecord( pxRecord->cText, fmt, vargs ) );
+}
+/*-----------------------------------------------------------*/
 
 void console_print( const char * fmt,
                     ... )
@@ -48,12 +698,38 @@ void console_print( const char * fmt,
     va_list vargs;
 
     va_start( vargs, fmt );
+    console_vprint( fmt, vargs );
+    va_end( vargs );
+}
+/*-----------------------------------------------------------*/
 
-    xSemaphoreTake( xStdioMutex, portMAX_DELAY );
+void console_flush( void )
+{
+    prvDrain();
+}
+/*-----------------------------------------------------------*/
 
-    vprintf( fmt, vargs );
+void console_get_stats( ConsoleStats_t * pxStats )
+{
+    pxStats->ulRecords = __atomic_load_n( &xStats.ulRecords, __ATOMIC_RELAXED );
+    pxStats->ulDropped = __atomic_load_n( &xStats.ulDropped, __ATOMIC_RELAXED );
+    pxStats->ulBlocked = __atomic_load_n( &xStats.ulBlocked, __ATOMIC_RELAXED );
+    pxStats->ulTruncated = __atomic_load_n( &xStats.ulTruncated, __ATOMIC_RELAXED );
+    pxStats->ulWrites = __atomic_load_n( &xStats.ulWrites, __ATOMIC_RELAXED );
+    pxStats->ulLocks = __atomic_load_n( &xStats.ulLocks, __ATOMIC_RELAXED );
+    pxStats->ullLockWait = __atomic_load_n( &xStats.ullLockWait, __ATOMIC_RELAXED );
+}
+/*-----------------------------------------------------------*/
 
-    xSemaphoreGive( xStdioMutex );
+static void prvFlusherTask( void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
 
-    va_end( vargs );
+    for( ; ; )
+    {
+        ulTaskNotifyTake( pdTRUE, consoleFLUSH_PERIOD );
+        prvDrain();
+    }
 }
+/*-----------------------------------------------------------*/
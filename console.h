@@ -27,17 +27,86 @@
 #ifndef CONSOLE_H
     #define CONSOLE_H
 
+    #include <stdarg.h>
+    #include <stddef.h>
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+
     #ifdef __cplusplus
         extern "C" {
     #endif
 
 /*-----------------------------------------------------------
 * Example console I/O wrappers.
+*
+* Once the scheduler runs, console_print() formats into a slot of a lock-free
+* multi-producer ring and returns; a low priority flusher task writes the
+* pending records out in batches, so that tasks logging do not wait on each
+* other nor on a Linux system call.  When the ring is full the record is
+* dropped and counted (eConsoleDrop), or the caller waits for the flusher
+* (eConsoleBlock).  eConsoleSync, and any call made while the scheduler is not
+* running, prints directly under xStdioMutex.
+*
+* eConsoleBinary defers the formatting as well (binary_log.h): the record only
+* holds the address of the format string, a timestamp, the task handle and
+* the raw arguments, and is dropped like with eConsoleDrop.  The flusher
+* formats it, or, once console_set_binary_file() has been called, dumps it in
+* binary form for tools/console_decode.c - the format strings of the messages
+* are dumped too.
+*
+* The first tasks that print get a buffer of their own, a byte ring that only
+* they write and only the flusher reads, so that a message is queued without
+* a lock or even an atomic read-modify-write shared with the other tasks.
+* The flusher writes out the ring, then each task buffer in turn: the
+* messages of one task keep their order, those of different tasks are only
+* ordered to within a flush period.  console_set_task_buffers( pdFALSE ) has
+* every task use the ring - to be called while nothing is printed.
+*
+* console_set_log_file() sends the output to a memory mapped file instead of
+* stdout (mmap_log.h): writing it out is then a memcpy(), and what was
+* written survives an abrupt exit.  tools/log_reader.c extracts it.
 *----------------------------------------------------------*/
 
+    typedef enum
+    {
+        eConsoleDrop = 0,
+        eConsoleBlock,
+        eConsoleSync,
+        eConsoleBinary,
+        eConsoleModeCount
+    } ConsoleMode_t;
+
+    typedef struct ConsoleStats
+    {
+        uint32_t ulRecords;   /* Queued in the ring or a task buffer. */
+        uint32_t ulDropped;   /* No room, with eConsoleDrop. */
+        uint32_t ulBlocked;   /* No room, waited for the flusher. */
+        uint32_t ulTruncated; /* Longer than a slot. */
+        uint32_t ulWrites;    /* Writes to stdout, batches or direct prints - none to a log file. */
+        uint32_t ulLocks;     /* Takes of xStdioMutex. */
+        uint64_t ullLockWait; /* Time spent waiting for it, run time counter units. */
+    } ConsoleStats_t;
+
     void console_init( void );
+    void console_set_mode( ConsoleMode_t xMode );
+    void console_set_task_buffers( BaseType_t xEnabled );
+
+/* Returns 0 on success, -1 if the file could not be created. */
+    int console_set_binary_file( const char * pcPath );
+
+/* Returns 0 on success, -1 if the file could not be created or mapped. */
+    int console_set_log_file( const char * pcPath,
+                              size_t xSize );
     void console_print( const char * fmt,
                         ... );
+    void console_vprint( const char * fmt,
+                         va_list vargs );
+
+/* Writes out whatever is pending, from a task or once the scheduler ended. */
+    void console_flush( void );
+    void console_get_stats( ConsoleStats_t * pxStats );
+    const char * console_mode_name( ConsoleMode_t xMode );
 
     #ifdef __cplusplus
         }
@@ -0,0 +1,264 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Periodic per-task CPU utilisation sampler - see cpu_sampler.h.
+*----------------------------------------------------------*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "cpu_sampler.h"
+
+/* The sampler preempts whatever it measures, so the samples are on time. */
+#define cpusamplerPRIORITY      ( configMAX_PRIORITIES - 1 )
+#define cpusamplerSTACK_SIZE    ( 1000UL )
+
+/* Room for the tasks created between counting the tasks and the snapshot. */
+#define cpusamplerSPARE_ENTRIES ( 16U )
+
+typedef struct CpuSnapshot
+{
+    TaskStatus_t * pxTasks; /* Sorted by task number. */
+    char * pcNames;         /* Copies the names point to: a task can be deleted before they are written. */
+    UBaseType_t uxCount;
+    UBaseType_t uxCapacity;
+    configRUN_TIME_COUNTER_TYPE ullTotalRunTime;
+    TickType_t xTakenAt;
+} CpuSnapshot_t;
+
+/*-----------------------------------------------------------*/
+
+static void prvSamplerTask( void * pvParameters );
+
+/*
+ * Fills pxSnapshot, growing it when tasks were added.  Returns pdFAIL if the
+ * tasks did not fit, or the memory ran out, leaving the snapshot empty.
+ */
+static BaseType_t prvTakeSnapshot( CpuSnapshot_t * pxSnapshot );
+
+/* Writes the share of each task that ran between the two snapshots. */
+static void prvWriteSample( const CpuSnapshot_t * pxPrevious,
+                            const CpuSnapshot_t * pxCurrent );
+
+static int prvCompareTaskNumbers( const void * pvA,
+                                  const void * pvB );
+
+/*-----------------------------------------------------------*/
+
+static FILE * pxSampleFile = NULL;
+static uint32_t ulSampleIntervalMs;
+static CpuSnapshot_t xSnapshots[ 2 ];
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xCpuSamplerStart( const char * pcPath,
+                             uint32_t ulIntervalMs )
+{
+    pxSampleFile = fopen( pcPath, "w" );
+
+    if( pxSampleFile == NULL )
+    {
+        return pdFAIL;
+    }
+
+    fprintf( pxSampleFile, "time_ms,task,number,priority,cpu_percent\n" );
+    ulSampleIntervalMs = ulIntervalMs;
+
+    if( xTaskCreate( prvSamplerTask, "CpuSampler", cpusamplerSTACK_SIZE, NULL, cpusamplerPRIORITY, NULL ) != pdPASS )
+    {
+        fclose( pxSampleFile );
+        pxSampleFile = NULL;
+        errno = ENOMEM;
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+void vCpuSamplerClose( void )
+{
+    if( pxSampleFile != NULL )
+    {
+        fclose( pxSampleFile );
+        pxSampleFile = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSamplerTask( void * pvParameters )
+{
+    CpuSnapshot_t * pxPrevious = &xSnapshots[ 0 ];
+    CpuSnapshot_t * pxCurrent = &xSnapshots[ 1 ];
+    TickType_t xLastWake = xTaskGetTickCount();
+
+    ( void ) pvParameters;
+
+    /* The first interval is measured from here, not from the start. */
+    ( void ) prvTakeSnapshot( pxPrevious );
+
+    for( ; ; )
+    {
+        xTaskDelayUntil( &xLastWake, pdMS_TO_TICKS( ulSampleIntervalMs ) );
+
+        /* After a failure the next sample covers both intervals. */
+        if( prvTakeSnapshot( pxCurrent ) == pdPASS )
+        {
+            CpuSnapshot_t * pxSwap = pxPrevious;
+
+            if( pxPrevious->uxCount > 0 )
+            {
+                prvWriteSample( pxPrevious, pxCurrent );
+            }
+
+            pxPrevious = pxCurrent;
+            pxCurrent = pxSwap;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTakeSnapshot( CpuSnapshot_t * pxSnapshot )
+{
+    UBaseType_t uxWanted = uxTaskGetNumberOfTasks() + cpusamplerSPARE_ENTRIES;
+
+    if( uxWanted > pxSnapshot->uxCapacity )
+    {
+        vPortFree( pxSnapshot->pxTasks );
+        vPortFree( pxSnapshot->pcNames );
+        pxSnapshot->pxTasks = pvPortMalloc( uxWanted * sizeof( TaskStatus_t ) );
+        pxSnapshot->pcNames = pvPortMalloc( uxWanted * configMAX_TASK_NAME_LEN );
+        pxSnapshot->uxCapacity = uxWanted;
+
+        if( ( pxSnapshot->pxTasks == NULL ) || ( pxSnapshot->pcNames == NULL ) )
+        {
+            vPortFree( pxSnapshot->pxTasks );
+            vPortFree( pxSnapshot->pcNames );
+            pxSnapshot->pxTasks = NULL;
+            pxSnapshot->pcNames = NULL;
+            pxSnapshot->uxCapacity = 0;
+        }
+    }
+
+    pxSnapshot->uxCount = 0;
+
+    if( pxSnapshot->pxTasks == NULL )
+    {
+        return pdFAIL;
+    }
+
+    /* No task can be deleted until the names are copied. */
+    vTaskSuspendAll();
+    {
+        /* Returns 0 if the tasks do not fit. */
+        pxSnapshot->uxCount = uxTaskGetSystemState( pxSnapshot->pxTasks, pxSnapshot->uxCapacity,
+                                                    &pxSnapshot->ullTotalRunTime );
+        pxSnapshot->xTakenAt = xTaskGetTickCount();
+
+        for( UBaseType_t x = 0; x < pxSnapshot->uxCount; x++ )
+        {
+            char * pcName = &pxSnapshot->pcNames[ x * configMAX_TASK_NAME_LEN ];
+
+            strncpy( pcName, pxSnapshot->pxTasks[ x ].pcTaskName, configMAX_TASK_NAME_LEN - 1 );
+            pcName[ configMAX_TASK_NAME_LEN - 1 ] = '\0';
+            pxSnapshot->pxTasks[ x ].pcTaskName = pcName;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    if( pxSnapshot->uxCount == 0 )
+    {
+        return pdFAIL;
+    }
+
+    qsort( pxSnapshot->pxTasks, pxSnapshot->uxCount, sizeof( TaskStatus_t ), prvCompareTaskNumbers );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteSample( const CpuSnapshot_t * pxPrevious,
+                            const CpuSnapshot_t * pxCurrent )
+{
+    configRUN_TIME_COUNTER_TYPE ullInterval = pxCurrent->ullTotalRunTime - pxPrevious->ullTotalRunTime;
+    unsigned long ulTimeMs = ( unsigned long ) ( pxCurrent->xTakenAt * portTICK_PERIOD_MS );
+    UBaseType_t uxOld = 0;
+
+    if( ullInterval == 0 )
+    {
+        return;
+    }
+
+    /* Both are sorted by task number: a task missing from the previous
+     * snapshot was created during the interval, and ran from zero. */
+    for( UBaseType_t x = 0; x < pxCurrent->uxCount; x++ )
+    {
+        const TaskStatus_t * pxTask = &pxCurrent->pxTasks[ x ];
+        configRUN_TIME_COUNTER_TYPE ullRan = pxTask->ulRunTimeCounter;
+
+        while( ( uxOld < pxPrevious->uxCount ) &&
+               ( pxPrevious->pxTasks[ uxOld ].xTaskNumber < pxTask->xTaskNumber ) )
+        {
+            uxOld++;
+        }
+
+        if( ( uxOld < pxPrevious->uxCount ) &&
+            ( pxPrevious->pxTasks[ uxOld ].xTaskNumber == pxTask->xTaskNumber ) )
+        {
+            ullRan -= pxPrevious->pxTasks[ uxOld ].ulRunTimeCounter;
+        }
+
+        if( ullRan > 0 )
+        {
+            fprintf( pxSampleFile, "%lu,%s,%lu,%lu,%.2f\n",
+                     ulTimeMs, pxTask->pcTaskName,
+                     ( unsigned long ) pxTask->xTaskNumber,
+                     ( unsigned long ) pxTask->uxCurrentPriority,
+                     ( double ) ullRan * 100.0 / ( double ) ullInterval );
+        }
+    }
+
+    fflush( pxSampleFile );
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareTaskNumbers( const void * pvA,
+                                  const void * pvB )
+{
+    UBaseType_t uxA = ( ( const TaskStatus_t * ) pvA )->xTaskNumber;
+    UBaseType_t uxB = ( ( const TaskStatus_t * ) pvB )->xTaskNumber;
+
+    return ( uxA > uxB ) - ( uxA < uxB );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,70 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef CPU_SAMPLER_H
+    #define CPU_SAMPLER_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Periodic per-task CPU utilisation sampler.
+*
+* A task at the highest priority takes a snapshot of uxTaskGetSystemState()
+* every ulIntervalMs and appends, for each task that ran since the previous
+* snapshot, its share of the run time counter over the interval to a CSV
+* file:
+*
+*   time_ms,task,number,priority,cpu_percent
+*
+* The shares are deltas, not totals since the scheduler started.  Tasks are
+* matched by their task number, which the kernel never reuses, so a task
+* created in place of a deleted one with the same name or handle starts from
+* zero.  Tasks that did not run in the interval are left out; the time of a
+* task deleted during the interval is lost, so the shares may add up to less
+* than 100.  The file is flushed after every sample.
+*----------------------------------------------------------*/
+
+/*
+ * Creates the sampler task and pcPath - call it before the scheduler starts.
+ * Returns pdFAIL, with errno set, if the file cannot be created.
+ */
+    BaseType_t xCpuSamplerStart( const char * pcPath,
+                                 uint32_t ulIntervalMs );
+
+/* Closes the file once the scheduler has ended, if the sampler was started. */
+    void vCpuSamplerClose( void );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* CPU_SAMPLER_H */
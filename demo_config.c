@@ -0,0 +1,660 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Command line handling for the demos.  Run './build/semaphore_demo --help'
+* for the list of options.
+*----------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "demo_config.h"
+#include "barrier.h"
+
+/* The defaults reproduce the behaviour of the demo before it could be
+ * configured: no pattern, Task1 + Task2, running forever. */
+DemoConfig_t xDemoConfig =
+{
+    .xDemo                   = eDemoSemaphores,
+    .xPattern                = ePatternNone,
+    .uxTaskCount             = 2,
+    .ulCriticalSectionLength = 0,
+    .ulRunSeconds            = 0,
+    .xBackoff                = eBackoffNone,
+    .xAllBackoffs            = pdFALSE,
+    .xBench                  = eBenchNone,
+    .xSweepTasks             = pdFALSE,
+    .uxPriorityCount         = 1,
+    .uxPriorities            = { tskIDLE_PRIORITY + 1 },
+    .xRwPolicy               = eRwLockReaderPreference,
+    .xAllRwPolicies          = pdFALSE,
+    .xNewsLock               = eNewsRwLock,
+    .uxReaderCount           = 4,
+    .uxWriterCount           = 1,
+    .ulReadPercent           = 90,
+    .ulOpRate                = 2000,
+    .pcCsvPath               = NULL,
+    .xConsoleMode            = eConsoleDrop,
+    .pcBinaryLogPath         = NULL,
+    .pcLogFilePath           = NULL,
+    .ulLogSizeKb             = 1024,
+    .pcCpuLogPath            = NULL,
+    .ulCpuIntervalMs         = 1000,
+    .ulStarvationMs          = 0
+};
+
+static const char * const pcPatternNames[] =
+{
+    [ ePatternNone ]       = "none",
+    [ ePatternBinary ]     = "binary",
+    [ ePatternCounting ]   = "counting",
+    [ ePatternMutex ]      = "mutex",
+    [ ePatternRendezVous ] = "rendezvous",
+    [ ePatternSeqlock ]    = "seqlock",
+    [ ePatternAll ]        = "all"
+};
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseUnsigned( const char * pcOption,
+                                    const char * pcValue,
+                                    uint32_t ulMin,
+                                    uint32_t ulMax,
+                                    uint32_t * pulResult )
+{
+    char * pcEnd = NULL;
+    unsigned long ulValue = strtoul( pcValue, &pcEnd, 0 );
+
+    if( ( pcEnd == pcValue ) || ( *pcEnd != '\0' ) || ( ulValue < ulMin ) || ( ulValue > ulMax ) )
+    {
+        fprintf( stderr, "Invalid value '%s' for --%s (expected %lu..%lu)\n",
+                 pcValue, pcOption, ( unsigned long ) ulMin, ( unsigned long ) ulMax );
+        return pdFAIL;
+    }
+
+    *pulResult = ( uint32_t ) ulValue;
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+/* Comma separated list of task priorities, e.g. "1,1,2,3". */
+static BaseType_t prvParsePriorities( const char * pcValue )
+{
+    char pcList[ 256 ];
+    char * pcSavePtr = NULL;
+    uint32_t ulPriority;
+
+    strncpy( pcList, pcValue, sizeof( pcList ) - 1 );
+    pcList[ sizeof( pcList ) - 1 ] = '\0';
+    xDemoConfig.uxPriorityCount = 0;
+
+    for( char * pcItem = strtok_r( pcList, ",", &pcSavePtr );
+         pcItem != NULL;
+         pcItem = strtok_r( NULL, ",", &pcSavePtr ) )
+    {
+        /* The top priority is kept for the supervisor task. */
+        if( ( xDemoConfig.uxPriorityCount == demoMAX_WORKER_TASKS ) ||
+            ( prvParseUnsigned( "priorities", pcItem, 1, configMAX_PRIORITIES - 2, &ulPriority ) != pdPASS ) )
+        {
+            return pdFAIL;
+        }
+
+        xDemoConfig.uxPriorities[ xDemoConfig.uxPriorityCount++ ] = ( UBaseType_t ) ulPriority;
+    }
+
+    if( xDemoConfig.uxPriorityCount == 0 )
+    {
+        fprintf( stderr, "Empty priority list\n" );
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParsePattern( const char * pcValue,
+                                   SemaphorePattern_t * pxPattern )
+{
+    for( size_t x = 0; x < sizeof( pcPatternNames ) / sizeof( pcPatternNames[ 0 ] ); x++ )
+    {
+        if( strcmp( pcValue, pcPatternNames[ x ] ) == 0 )
+        {
+            *pxPattern = ( SemaphorePattern_t ) x;
+            return pdPASS;
+        }
+    }
+
+    fprintf( stderr, "Unknown pattern '%s'\n", pcValue );
+    return pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseBackoff( const char * pcValue )
+{
+    if( strcmp( pcValue, "all" ) == 0 )
+    {
+        xDemoConfig.xAllBackoffs = pdTRUE;
+        return pdPASS;
+    }
+
+    for( BackoffPolicy_t xPolicy = eBackoffNone; xPolicy < eBackoffCount; xPolicy++ )
+    {
+        if( strcmp( pcValue, pcBackoffPolicyName( xPolicy ) ) == 0 )
+        {
+            xDemoConfig.xBackoff = xPolicy;
+            xDemoConfig.xAllBackoffs = pdFALSE;
+            return pdPASS;
+        }
+    }
+
+    fprintf( stderr, "Unknown back-off policy '%s'\n", pcValue );
+    return pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseConsoleMode( const char * pcValue )
+{
+    for( ConsoleMode_t xMode = eConsoleDrop; xMode < eConsoleModeCount; xMode++ )
+    {
+        if( strcmp( pcValue, console_mode_name( xMode ) ) == 0 )
+        {
+            xDemoConfig.xConsoleMode = xMode;
+            return pdPASS;
+        }
+    }
+
+    fprintf( stderr, "Unknown console mode '%s'\n", pcValue );
+    return pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseRwPolicy( const char * pcValue )
+{
+    xDemoConfig.xAllRwPolicies = pdFALSE;
+    xDemoConfig.xNewsLock = eNewsRwLock;
+
+    if( strcmp( pcValue, "all" ) == 0 )
+    {
+        xDemoConfig.xAllRwPolicies = pdTRUE;
+        return pdPASS;
+    }
+
+    if( strcmp( pcValue, "big-reader" ) == 0 )
+    {
+        xDemoConfig.xNewsLock = eNewsBigReader;
+        return pdPASS;
+    }
+
+    if( strcmp( pcValue, "rcu" ) == 0 )
+    {
+        xDemoConfig.xNewsLock = eNewsRcu;
+        return pdPASS;
+    }
+
+    for( RwLockPolicy_t xPolicy = eRwLockReaderPreference; xPolicy < eRwLockPolicyCount; xPolicy++ )
+    {
+        if( strcmp( pcValue, pcRwLockPolicyName( xPolicy ) ) == 0 )
+        {
+            xDemoConfig.xRwPolicy = xPolicy;
+            return pdPASS;
+        }
+    }
+
+    fprintf( stderr, "Unknown readers-writer policy '%s'\n", pcValue );
+    return pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+const char * pcDemoPatternName( SemaphorePattern_t xPattern )
+{
+    if( ( size_t ) xPattern < sizeof( pcPatternNames ) / sizeof( pcPatternNames[ 0 ] ) )
+    {
+        return pcPatternNames[ xPattern ];
+    }
+
+    return "?";
+}
+/*-----------------------------------------------------------*/
+
+void vDemoConfigPrintUsage( const char * pcProgramName )
+{
+    printf( "Usage: %s [options]\n"
+            "  -D, --demo NAME        semaphores | readers-writer | priority-inversion (default semaphores)\n"
+            "  -p, --pattern NAME     none | binary | counting | mutex | rendezvous | seqlock | all\n"
+            "  -n, --tasks N          tasks running the Task1/Task2 workload (1..%u, default 2)\n"
+            "  -c, --cs-length US     critical section length in microseconds of calibrated work (default 0)\n"
+            "  -d, --duration S       seconds per pattern, 0 runs forever (default 0, 10 with 'all')\n"
+            "  -B, --backoff POLICY   what Task1/Task2 do when mainSemaphore is busy: none | immediate |\n"
+            "                         exponential | yield | bounded | all (default none, drop the update)\n"
+            "  -b, --bench[=NAME]     run a benchmark instead of the Task1/Task2 workload (default duration 5):\n"
+            "                         contention - all tasks hammer take/give on mainSemaphore (the default,\n"
+            "                                      patterns binary | counting | mutex | all)\n"
+            "                         publish    - one reader and --tasks - 1 writers share printoutText\n"
+            "                                      (all patterns but rendezvous)\n"
+            "                         signal     - signal-to-wake latency of a binary semaphore and of a\n"
+            "                                      task notification (pattern and tasks are ignored)\n"
+            "                         barrier    - release skew of --tasks tasks (2..%u) cycling through\n"
+            "                                      a barrier, after --cs-length of work each\n"
+            "                         adaptive   - contention, once with blocking takes and once with\n"
+            "                                      spin-then-block takes (adaptive_semaphore.c)\n"
+            "                         logging    - cost of a console_print() call from --tasks tasks, in\n"
+            "                                      the sync mode, the drop mode through the shared ring\n"
+            "                                      and through the task buffers, and the binary mode\n"
+            "                         rwlock     - readers-writer lock throughput of --tasks tasks at several\n"
+            "                                      read/write ratios (the default with --demo readers-writer)\n"
+            "                         brlock     - read throughput of 4 .. 256 readers and one writer, with the\n"
+            "                                      --rw-policy lock, the big-reader lock and rcu\n"
+            "                         upgrade    - exclusive hold time of 2 writers that read before deciding to\n"
+            "                                      write, next to --tasks readers, with write locks and with\n"
+            "                                      upgradable read locks\n"
+            "                         coalesce   - reader blocking of --tasks readers while 4 producers change\n"
+            "                                      the newspaper, with a write lock per change and with the\n"
+            "                                      changes batched by a single writer (write_batcher.c)\n"
+            "                         workload   - --readers readers and --writers writers sharing --op-rate\n"
+            "                                      operations per second, --read-percent of them reads, with\n"
+            "                                      per-second throughput and latency percentiles\n"
+            "  -w, --rw-policy NAME   readers-writer lock policy: reader-pref | writer-pref | phase-fair |\n"
+            "                         big-reader | rcu | all (default reader-pref, all with --bench=rwlock\n"
+            "                         upgrade, coalesce and workload)\n"
+            "  -S, --starvation-ms MS alarm when a readers-writer update is pending for longer (default\n"
+            "                         3 writer periods, 1000 with --bench)\n"
+            "  -r, --readers N        reader tasks of the readers-writer demo and workload (1..%u, default 4)\n"
+            "  -W, --writers N        writer tasks of the workload (0..%u, default 1)\n"
+            "  -R, --read-percent P   share of the workload operations that are reads (0..100, default 90)\n"
+            "  -o, --op-rate N        operations per second offered by the workload tasks (default 2000)\n"
+            "  -C, --csv FILE         write the per-second workload results to FILE\n"
+            "  -L, --console MODE     drop | block | sync | binary: console output is queued and written\n"
+            "                         by a flusher task, dropping or waiting when the queue is full,\n"
+            "                         printed directly, or queued unformatted (default drop)\n"
+            "  -F, --binlog FILE      with --console binary, dump the messages to FILE for\n"
+            "                         console_decode instead of formatting them\n"
+            "  -M, --log-file FILE    write the console output to a ring in the memory mapped FILE,\n"
+            "                         kept on an abrupt exit, instead of stdout - see log_reader\n"
+            "  -K, --log-size KB      size of the --log-file ring (4..1048576, default 1024)\n"
+            "  -T, --cpu-log FILE     write the CPU share of each task over every --cpu-interval to FILE\n"
+            "  -I, --cpu-interval MS  sampling interval of --cpu-log (10..60000, default 1000)\n"
+            "  -P, --priorities LIST  comma separated priorities given to the tasks in turn (1..%u, default 1)\n"
+            "  -s, --sweep            repeat the benchmark with 1, 2, 4 .. --tasks tasks\n"
+            "  -h, --help             show this help\n",
+            pcProgramName, ( unsigned ) demoMAX_WORKER_TASKS, ( unsigned ) barrierMAX_PARTIES,
+            ( unsigned ) demoMAX_READERS, ( unsigned ) demoMAX_WORKER_TASKS,
+            ( unsigned ) ( configMAX_PRIORITIES - 2 ) );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDemoConfigParse( int argc,
+                             char * argv[] )
+{
+    static const struct option xLongOptions[] =
+    {
+        { "demo",          required_argument, NULL, 'D' },
+        { "pattern",       required_argument, NULL, 'p' },
+        { "tasks",         required_argument, NULL, 'n' },
+        { "cs-length",     required_argument, NULL, 'c' },
+        { "duration",      required_argument, NULL, 'd' },
+        { "backoff",       required_argument, NULL, 'B' },
+        { "bench",         optional_argument, NULL, 'b' },
+        { "priorities",    required_argument, NULL, 'P' },
+        { "sweep",         no_argument,       NULL, 's' },
+        { "rw-policy",     required_argument, NULL, 'w' },
+        { "starvation-ms", required_argument, NULL, 'S' },
+        { "readers",       required_argument, NULL, 'r' },
+        { "writers",       required_argument, NULL, 'W' },
+        { "read-percent",  required_argument, NULL, 'R' },
+        { "op-rate",       required_argument, NULL, 'o' },
+        { "csv",           required_argument, NULL, 'C' },
+        { "console",       required_argument, NULL, 'L' },
+        { "binlog",        required_argument, NULL, 'F' },
+        { "log-file",      required_argument, NULL, 'M' },
+        { "log-size",      required_argument, NULL, 'K' },
+        { "cpu-log",       required_argument, NULL, 'T' },
+        { "cpu-interval",  required_argument, NULL, 'I' },
+        { "help",          no_argument,       NULL, 'h' },
+        { NULL,            0,                 NULL, 0   }
+    };
+    BaseType_t xResult = pdPASS;
+    BaseType_t xDurationGiven = pdFALSE;
+    BaseType_t xBenchNamed = pdFALSE;
+    BaseType_t xRwPolicyGiven = pdFALSE;
+    uint32_t ulValue;
+    int iOption;
+
+    while( ( xResult == pdPASS ) &&
+           ( ( iOption = getopt_long( argc, argv, "D:p:n:c:d:B:b::P:sw:S:r:W:R:o:C:L:F:M:K:T:I:h", xLongOptions, NULL ) ) != -1 ) )
+    {
+        switch( iOption )
+        {
+            case 'D':
+
+                if( strcmp( optarg, "semaphores" ) == 0 )
+                {
+                    xDemoConfig.xDemo = eDemoSemaphores;
+                }
+                else if( strcmp( optarg, "readers-writer" ) == 0 )
+                {
+                    xDemoConfig.xDemo = eDemoReadersWriter;
+                }
+                else if( strcmp( optarg, "priority-inversion" ) == 0 )
+                {
+                    xDemoConfig.xDemo = eDemoPriorityInversion;
+                }
+                else
+                {
+                    fprintf( stderr, "Unknown demo '%s'\n", optarg );
+                    xResult = pdFAIL;
+                }
+
+                break;
+
+            case 'p':
+                xResult = prvParsePattern( optarg, &xDemoConfig.xPattern );
+                break;
+
+            case 'n':
+                xResult = prvParseUnsigned( "tasks", optarg, 1, demoMAX_WORKER_TASKS, &ulValue );
+                xDemoConfig.uxTaskCount = ( UBaseType_t ) ulValue;
+                break;
+
+            case 'c':
+                xResult = prvParseUnsigned( "cs-length", optarg, 0, 10UL * 1000000UL, &xDemoConfig.ulCriticalSectionLength );
+                break;
+
+            case 'd':
+                xResult = prvParseUnsigned( "duration", optarg, 0, 24UL * 3600UL, &xDemoConfig.ulRunSeconds );
+                xDurationGiven = pdTRUE;
+                break;
+
+            case 'B':
+                xResult = prvParseBackoff( optarg );
+                break;
+
+            case 'b':
+
+                xBenchNamed = ( optarg != NULL ) ? pdTRUE : pdFALSE;
+
+                if( ( optarg == NULL ) || ( strcmp( optarg, "contention" ) == 0 ) )
+                {
+                    xDemoConfig.xBench = eBenchContention;
+                }
+                else if( strcmp( optarg, "publish" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchPublish;
+                }
+                else if( strcmp( optarg, "signal" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchSignal;
+                }
+                else if( strcmp( optarg, "barrier" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchBarrier;
+                }
+                else if( strcmp( optarg, "adaptive" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchAdaptive;
+                }
+                else if( strcmp( optarg, "logging" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchLogging;
+                }
+                else if( strcmp( optarg, "rwlock" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchRwLock;
+                }
+                else if( strcmp( optarg, "brlock" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchBigReader;
+                }
+                else if( strcmp( optarg, "upgrade" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchUpgrade;
+                }
+                else if( strcmp( optarg, "coalesce" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchCoalesce;
+                }
+                else if( strcmp( optarg, "workload" ) == 0 )
+                {
+                    xDemoConfig.xBench = eBenchWorkload;
+                }
+                else
+                {
+                    fprintf( stderr, "Unknown benchmark '%s'\n", optarg );
+                    xResult = pdFAIL;
+                }
+
+                break;
+
+            case 'P':
+                xResult = prvParsePriorities( optarg );
+                break;
+
+            case 's':
+                xDemoConfig.xSweepTasks = pdTRUE;
+                break;
+
+            case 'w':
+                xResult = prvParseRwPolicy( optarg );
+                xRwPolicyGiven = pdTRUE;
+                break;
+
+            case 'S':
+                xResult = prvParseUnsigned( "starvation-ms", optarg, 1, 24UL * 3600UL * 1000UL, &xDemoConfig.ulStarvationMs );
+                break;
+
+            case 'r':
+                xResult = prvParseUnsigned( "readers", optarg, 1, demoMAX_READERS, &ulValue );
+                xDemoConfig.uxReaderCount = ( UBaseType_t ) ulValue;
+                break;
+
+            case 'W':
+                xResult = prvParseUnsigned( "writers", optarg, 0, demoMAX_WORKER_TASKS, &ulValue );
+                xDemoConfig.uxWriterCount = ( UBaseType_t ) ulValue;
+                break;
+
+            case 'R':
+                xResult = prvParseUnsigned( "read-percent", optarg, 0, 100, &xDemoConfig.ulReadPercent );
+                break;
+
+            case 'o':
+                xResult = prvParseUnsigned( "op-rate", optarg, 1, 10UL * 1000000UL, &xDemoConfig.ulOpRate );
+                break;
+
+            case 'C':
+                xDemoConfig.pcCsvPath = optarg;
+                break;
+
+            case 'L':
+                xResult = prvParseConsoleMode( optarg );
+                break;
+
+            case 'F':
+                xDemoConfig.pcBinaryLogPath = optarg;
+                break;
+
+            case 'M':
+                xDemoConfig.pcLogFilePath = optarg;
+                break;
+
+            case 'K':
+                xResult = prvParseUnsigned( "log-size", optarg, 4, 1024UL * 1024UL, &xDemoConfig.ulLogSizeKb );
+                break;
+
+            case 'T':
+                xDemoConfig.pcCpuLogPath = optarg;
+                break;
+
+            case 'I':
+                xResult = prvParseUnsigned( "cpu-interval", optarg, 10, 60000, &xDemoConfig.ulCpuIntervalMs );
+                break;
+
+            case 'h':
+            default:
+                xResult = pdFAIL;
+                break;
+        }
+    }
+
+    if( ( xResult == pdPASS ) && ( optind < argc ) )
+    {
+        fprintf( stderr, "Unexpected argument '%s'\n", argv[ optind ] );
+        xResult = pdFAIL;
+    }
+
+    /* The readers-writer demo has a benchmark of its own. */
+    if( ( xResult == pdPASS ) && ( xDemoConfig.xDemo == eDemoReadersWriter ) )
+    {
+        if( ( xDemoConfig.xBench == eBenchContention ) && ( xBenchNamed == pdFALSE ) )
+        {
+            xDemoConfig.xBench = eBenchRwLock;
+        }
+
+        if( ( xDemoConfig.xBench != eBenchNone ) && ( xDemoConfig.xBench != eBenchRwLock ) &&
+            ( xDemoConfig.xBench != eBenchBigReader ) && ( xDemoConfig.xBench != eBenchUpgrade ) &&
+            ( xDemoConfig.xBench != eBenchCoalesce ) && ( xDemoConfig.xBench != eBenchWorkload ) )
+        {
+            fprintf( stderr, "--demo readers-writer only supports --bench=rwlock, brlock, upgrade, coalesce and workload\n" );
+            xResult = pdFAIL;
+        }
+
+        /* The big-reader lock is compared with a single policy. */
+        if( ( xDemoConfig.xBench == eBenchBigReader ) &&
+            ( ( xDemoConfig.xAllRwPolicies == pdTRUE ) || ( xDemoConfig.xNewsLock != eNewsRwLock ) ) )
+        {
+            fprintf( stderr, "--bench=brlock needs --rw-policy reader-pref, writer-pref or phase-fair\n" );
+            xResult = pdFAIL;
+        }
+
+        /* Only the readers-writer lock has upgradable read locks. */
+        if( ( xDemoConfig.xBench == eBenchUpgrade ) && ( xDemoConfig.xNewsLock != eNewsRwLock ) )
+        {
+            fprintf( stderr, "--bench=upgrade needs --rw-policy reader-pref, writer-pref, phase-fair or all\n" );
+            xResult = pdFAIL;
+        }
+
+        if( ( ( xDemoConfig.xBench == eBenchRwLock ) || ( xDemoConfig.xBench == eBenchUpgrade ) ||
+              ( xDemoConfig.xBench == eBenchCoalesce ) || ( xDemoConfig.xBench == eBenchWorkload ) ) &&
+            ( xRwPolicyGiven == pdFALSE ) )
+        {
+            xDemoConfig.xAllRwPolicies = pdTRUE;
+        }
+
+        if( ( xDemoConfig.xBench == eBenchNone ) && ( xDemoConfig.xAllRwPolicies == pdTRUE ) )
+        {
+            fprintf( stderr, "--rw-policy all needs --bench=rwlock, upgrade, coalesce or workload\n" );
+            xResult = pdFAIL;
+        }
+    }
+    else if( ( xResult == pdPASS ) &&
+             ( ( xDemoConfig.xBench == eBenchRwLock ) || ( xDemoConfig.xBench == eBenchBigReader ) ||
+               ( xDemoConfig.xBench == eBenchUpgrade ) || ( xDemoConfig.xBench == eBenchCoalesce ) ||
+               ( xDemoConfig.xBench == eBenchWorkload ) ) )
+    {
+        fprintf( stderr, "--bench=rwlock, brlock, upgrade, coalesce and workload need --demo readers-writer\n" );
+        xResult = pdFAIL;
+    }
+
+    if( ( xResult == pdPASS ) && ( xDemoConfig.pcBinaryLogPath != NULL ) &&
+        ( xDemoConfig.xConsoleMode != eConsoleBinary ) && ( xDemoConfig.xBench != eBenchLogging ) )
+    {
+        fprintf( stderr, "--binlog needs --console binary or --bench=logging\n" );
+        xResult = pdFAIL;
+    }
+
+    if( ( xResult == pdPASS ) && ( xDemoConfig.xBench != eBenchNone ) )
+    {
+        /* The contention benchmark needs mainSemaphore, and both need a
+         * result at some point. */
+        if( ( ( xDemoConfig.xBench == eBenchContention ) || ( xDemoConfig.xBench == eBenchAdaptive ) ) &&
+            ( ( xDemoConfig.xPattern == ePatternNone ) ||
+              ( xDemoConfig.xPattern == ePatternRendezVous ) ||
+              ( xDemoConfig.xPattern == ePatternSeqlock ) ) )
+        {
+            fprintf( stderr, "--bench=contention and adaptive need --pattern binary, counting, mutex or all\n" );
+            xResult = pdFAIL;
+        }
+
+        if( ( xDemoConfig.xBench == eBenchPublish ) && ( xDemoConfig.xPattern == ePatternRendezVous ) )
+        {
+            fprintf( stderr, "--bench=publish does not support the rendezvous pattern\n" );
+            xResult = pdFAIL;
+        }
+
+        if( ( xDemoConfig.xBench == eBenchBarrier ) &&
+            ( ( xDemoConfig.uxTaskCount < 2 ) || ( xDemoConfig.uxTaskCount > barrierMAX_PARTIES ) ) )
+        {
+            fprintf( stderr, "--bench=barrier needs 2..%u tasks\n", ( unsigned ) barrierMAX_PARTIES );
+            xResult = pdFAIL;
+        }
+
+        if( ( xDemoConfig.xBench == eBenchPublish ) && ( xDemoConfig.uxTaskCount < 2 ) )
+        {
+            fprintf( stderr, "--bench=publish needs at least 2 tasks\n" );
+            xResult = pdFAIL;
+        }
+
+        if( xDurationGiven == pdFALSE )
+        {
+            xDemoConfig.ulRunSeconds = 5;
+        }
+
+        if( xDemoConfig.ulRunSeconds == 0 )
+        {
+            fprintf( stderr, "--bench needs a non-zero --duration\n" );
+            xResult = pdFAIL;
+        }
+    }
+
+    /* Comparing patterns, or policies, only makes sense if each one stops
+     * at some point. */
+    if( ( ( xDemoConfig.xPattern == ePatternAll ) || ( xDemoConfig.xAllBackoffs == pdTRUE ) ) &&
+        ( xDurationGiven == pdFALSE ) && ( xDemoConfig.xBench == eBenchNone ) )
+    {
+        xDemoConfig.ulRunSeconds = 10;
+    }
+
+    if( ( xDemoConfig.xPattern == ePatternAll ) && ( xDemoConfig.ulRunSeconds == 0 ) )
+    {
+        fprintf( stderr, "--pattern all needs a non-zero --duration\n" );
+        xResult = pdFAIL;
+    }
+
+    if( ( xDemoConfig.xAllBackoffs == pdTRUE ) && ( xDemoConfig.ulRunSeconds == 0 ) )
+    {
+        fprintf( stderr, "--backoff all needs a non-zero --duration\n" );
+        xResult = pdFAIL;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,151 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef DEMO_CONFIG_H
+    #define DEMO_CONFIG_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+
+    #include "console.h"
+    #include "try_take.h"
+    #include "rw_lock.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Run time configuration of the demos, filled in from the command line.
+*----------------------------------------------------------*/
+
+/* Upper bound for the number of worker tasks a pattern can be run with. */
+    #define demoMAX_WORKER_TASKS    ( 64U )
+
+/* Upper bound for the number of readers of the readers-writer demo, whose
+ * tasks come from a statically allocated pool of this size. */
+    #define demoMAX_READERS         ( 1024U )
+
+/* The demo started by main(). */
+    typedef enum
+    {
+        eDemoSemaphores = 0,
+        eDemoReadersWriter,
+        eDemoPriorityInversion
+    } DemoSelection_t;
+
+/* Semaphore patterns of main_semaphores.c - ePatternAll runs them one after
+ * the other so that they can be compared within a single run. */
+    typedef enum
+    {
+        ePatternNone = 0,
+        ePatternBinary,
+        ePatternCounting,
+        ePatternMutex,
+        ePatternRendezVous,
+        ePatternSeqlock, /* Lock-free publication of printoutText. */
+        ePatternAll
+    } SemaphorePattern_t;
+
+/* Benchmarks replacing the Task1/Task2 workload of main_semaphores.c. */
+    typedef enum
+    {
+        eBenchNone = 0,
+        eBenchContention, /* All tasks hammer take/give on mainSemaphore. */
+        eBenchPublish,    /* Writers publish printoutText, one task reads it. */
+        eBenchSignal,     /* Signal-to-wake latency of semaphores vs notifications. */
+        eBenchBarrier,    /* Release skew of the N task barrier. */
+        eBenchAdaptive,   /* The contention benchmark, with blocking and with spin-then-block takes. */
+        eBenchLogging,    /* Cost of a console_print() call in each console mode. */
+        eBenchRwLock,     /* Readers-writer lock throughput per policy and read/write ratio. */
+        eBenchBigReader,  /* Read throughput of 4 .. 256 readers, with --rw-policy, the big-reader lock and RCU. */
+        eBenchUpgrade,    /* Exclusive hold time of deciding writers, with write locks and upgradable read locks. */
+        eBenchCoalesce,   /* Reader blocking with a write lock per change and with batched changes. */
+        eBenchWorkload    /* Readers and writers at a given operation rate and read/write ratio, per second. */
+    } BenchMode_t;
+
+/* How the readers-writer demo protects the newspaper. */
+    typedef enum
+    {
+        eNewsRwLock = 0,   /* rw_lock.c, with the xRwPolicy policy. */
+        eNewsBigReader,    /* big_reader_lock.c. */
+        eNewsRcu           /* rcu.c - readers do not lock at all. */
+    } NewsLock_t;
+
+    typedef struct DemoConfig
+    {
+        DemoSelection_t xDemo;
+        SemaphorePattern_t xPattern;
+        UBaseType_t uxTaskCount;          /* Number of tasks running the Task1/Task2 workload. */
+        uint32_t ulCriticalSectionLength; /* Calibrated work done in the critical section, in microseconds. */
+        uint32_t ulRunSeconds;            /* Run time per pattern, 0 runs forever. */
+        BackoffPolicy_t xBackoff;         /* What Task1/Task2 do when mainSemaphore is busy. */
+        BaseType_t xAllBackoffs;          /* Run the patterns once with each back-off policy. */
+
+        /* Benchmarks of main_semaphores.c. */
+        BenchMode_t xBench;
+        BaseType_t xSweepTasks;                           /* Repeat with 1, 2, 4 .. uxTaskCount tasks. */
+        UBaseType_t uxPriorityCount;
+        UBaseType_t uxPriorities[ demoMAX_WORKER_TASKS ]; /* Given to the tasks in turn. */
+
+        /* Readers-writer demo. */
+        RwLockPolicy_t xRwPolicy;
+        BaseType_t xAllRwPolicies; /* Benchmark each policy in turn. */
+        NewsLock_t xNewsLock;
+        UBaseType_t uxReaderCount; /* Reader tasks of the demo and of the workload. */
+
+        /* Workload generator of the readers-writer demo. */
+        UBaseType_t uxWriterCount;
+        uint32_t ulReadPercent;    /* Share of the operations that are reads. */
+        uint32_t ulOpRate;         /* Operations per second offered by all the tasks. */
+        const char * pcCsvPath;    /* Per-second results, NULL for none. */
+
+        ConsoleMode_t xConsoleMode;
+        const char * pcBinaryLogPath; /* Dump of --console binary, NULL to format it. */
+        const char * pcLogFilePath;   /* Memory mapped console output, NULL for stdout. */
+        uint32_t ulLogSizeKb;
+        const char * pcCpuLogPath;    /* Per-task CPU shares over time, NULL for none. */
+        uint32_t ulCpuIntervalMs;
+        uint32_t ulStarvationMs;   /* Writer starvation alarm bound, 0 for the default. */
+    } DemoConfig_t;
+
+    extern DemoConfig_t xDemoConfig;
+
+/*
+ * Parse the command line into xDemoConfig.  Returns pdFAIL, after printing
+ * the reason, if an option is unknown or out of range.
+ */
+    BaseType_t xDemoConfigParse( int argc,
+                                 char * argv[] );
+    void vDemoConfigPrintUsage( const char * pcProgramName );
+    const char * pcDemoPatternName( SemaphorePattern_t xPattern );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* DEMO_CONFIG_H */
@@ -0,0 +1,161 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Log-linear latency histogram - see latency_histogram.h.
+*----------------------------------------------------------*/
+
+#include <string.h>
+
+/* Local includes. */
+#include "latency_histogram.h"
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvBucketIndex( uint64_t ullValue )
+{
+    uint32_t ulMsb;
+
+    if( ullValue < histSUB_BUCKETS )
+    {
+        return ( uint32_t ) ullValue;
+    }
+
+    /* The bucket is given by the position of the most significant bit,
+     * refined by the histSUB_BUCKET_BITS bits that follow it. */
+    ulMsb = 63U - ( uint32_t ) __builtin_clzll( ullValue );
+
+    return ( ulMsb - histSUB_BUCKET_BITS + 1U ) * histSUB_BUCKETS +
+           ( uint32_t ) ( ( ullValue >> ( ulMsb - histSUB_BUCKET_BITS ) ) & ( histSUB_BUCKETS - 1U ) );
+}
+/*-----------------------------------------------------------*/
+
+/* Largest value that falls into the bucket. */
+static uint64_t prvBucketUpperBound( uint32_t ulIndex )
+{
+    uint32_t ulShift;
+
+    if( ulIndex < histSUB_BUCKETS )
+    {
+        return ulIndex;
+    }
+
+    ulShift = ulIndex / histSUB_BUCKETS - 1U;
+
+    return ( ( ( uint64_t ) histSUB_BUCKETS + ( ulIndex % histSUB_BUCKETS ) ) << ulShift ) +
+           ( ( ( uint64_t ) 1U << ulShift ) - 1U );
+}
+/*-----------------------------------------------------------*/
+
+void vHistogramReset( LatencyHistogram_t * pxHistogram )
+{
+    memset( pxHistogram, 0, sizeof( *pxHistogram ) );
+    pxHistogram->ullMin = UINT64_MAX;
+}
+/*-----------------------------------------------------------*/
+
+void vHistogramRecord( LatencyHistogram_t * pxHistogram,
+                       uint64_t ullValue )
+{
+    pxHistogram->ulBuckets[ prvBucketIndex( ullValue ) ]++;
+    pxHistogram->ullCount++;
+    pxHistogram->ullSum += ullValue;
+
+    if( ullValue < pxHistogram->ullMin )
+    {
+        pxHistogram->ullMin = ullValue;
+    }
+
+    if( ullValue > pxHistogram->ullMax )
+    {
+        pxHistogram->ullMax = ullValue;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vHistogramMerge( LatencyHistogram_t * pxInto,
+                      const LatencyHistogram_t * pxFrom )
+{
+    for( uint32_t x = 0; x < histBUCKET_COUNT; x++ )
+    {
+        pxInto->ulBuckets[ x ] += pxFrom->ulBuckets[ x ];
+    }
+
+    pxInto->ullCount += pxFrom->ullCount;
+    pxInto->ullSum += pxFrom->ullSum;
+
+    if( pxFrom->ullMin < pxInto->ullMin )
+    {
+        pxInto->ullMin = pxFrom->ullMin;
+    }
+
+    if( pxFrom->ullMax > pxInto->ullMax )
+    {
+        pxInto->ullMax = pxFrom->ullMax;
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullHistogramPercentile( const LatencyHistogram_t * pxHistogram,
+                                 double dPercentile )
+{
+    uint64_t ullRank;
+    uint64_t ullSeen = 0;
+
+    if( pxHistogram->ullCount == 0 )
+    {
+        return 0;
+    }
+
+    /* Rank of the value looked for, 1 based. */
+    ullRank = ( uint64_t ) ( dPercentile / 100.0 * ( double ) pxHistogram->ullCount + 0.999999 );
+
+    if( ullRank == 0 )
+    {
+        ullRank = 1;
+    }
+
+    for( uint32_t x = 0; x < histBUCKET_COUNT; x++ )
+    {
+        ullSeen += pxHistogram->ulBuckets[ x ];
+
+        if( ullSeen >= ullRank )
+        {
+            uint64_t ullUpper = prvBucketUpperBound( x );
+
+            return ( ullUpper < pxHistogram->ullMax ) ? ullUpper : pxHistogram->ullMax;
+        }
+    }
+
+    return pxHistogram->ullMax;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullHistogramMean( const LatencyHistogram_t * pxHistogram )
+{
+    return ( pxHistogram->ullCount > 0 ) ? pxHistogram->ullSum / pxHistogram->ullCount : 0;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,80 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+    #define LATENCY_HISTOGRAM_H
+
+    #include <stdint.h>
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Log-linear latency histogram.
+*
+* Values below 2^histSUB_BUCKET_BITS get a bucket each, larger values are
+* split into histSUB_BUCKETS buckets per power of two, so that every recorded
+* value is known to within ~6% over the full 64 bit range, using a fixed
+* amount of memory and no floating point on the recording path.
+*
+* The functions do not lock - a histogram shared between tasks must be
+* updated from within a critical section.
+*----------------------------------------------------------*/
+
+    #define histSUB_BUCKET_BITS    ( 4U )
+    #define histSUB_BUCKETS        ( 1U << histSUB_BUCKET_BITS )
+    #define histBUCKET_COUNT       ( ( 64U - histSUB_BUCKET_BITS + 1U ) * histSUB_BUCKETS )
+
+    typedef struct LatencyHistogram
+    {
+        uint32_t ulBuckets[ histBUCKET_COUNT ];
+        uint64_t ullCount;
+        uint64_t ullSum;
+        uint64_t ullMin;
+        uint64_t ullMax;
+    } LatencyHistogram_t;
+
+    void vHistogramReset( LatencyHistogram_t * pxHistogram );
+    void vHistogramRecord( LatencyHistogram_t * pxHistogram,
+                           uint64_t ullValue );
+    void vHistogramMerge( LatencyHistogram_t * pxInto,
+                          const LatencyHistogram_t * pxFrom );
+
+/*
+ * Value below which dPercentile percent (0.0 .. 100.0) of the recorded values
+ * fall, rounded up to the end of its bucket.  Returns 0 for an empty
+ * histogram.
+ */
+    uint64_t ullHistogramPercentile( const LatencyHistogram_t * pxHistogram,
+                                     double dPercentile );
+    uint64_t ullHistogramMean( const LatencyHistogram_t * pxHistogram );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* LATENCY_HISTOGRAM_H */
@@ -49,6 +49,12 @@
 
 /* Local includes. */
 #include "console.h"
+#include "demo_config.h"
+#include "work_units.h"
+#include "rcu.h"
+#include "run_time_stats.h"
+#include "cpu_sampler.h"
+#include "sem_profiler.h"
 
 #ifdef BUILD_DIR
     #define BUILD         BUILD_DIR
@@ -61,7 +67,9 @@
 /*-----------------------------------------------------------*/
 extern void main_semaphores( void );
 extern void main_readers_writer( void );
+extern void main_priority_inversion( void );
 static void traceOnEnter( void );
+static void prvReportConsole( void );
 
 /*
  * Only the comprehensive demo uses application hook (callback) functions.  See
@@ -112,27 +120,102 @@ static BaseType_t xTraceRunning = pdTRUE;
 
 /*-----------------------------------------------------------*/
 
-int main( void )
+int main( int argc,
+          char * argv[] )
 {
+    if( xDemoConfigParse( argc, argv ) != pdPASS )
+    {
+        vDemoConfigPrintUsage( argv[ 0 ] );
+        return 1;
+    }
+
     /* SIGINT is not blocked by the posix port */
     signal( SIGINT, handle_sigint );
 
     /* Initialise the trace recorder.  Use of the trace recorder is optional.
-    * See http://www.FreeRTOS.org/trace for more information. */
-    vTraceEnable( TRC_START );
-    uiTraceStart(); 
+    * See http://www.FreeRTOS.org/trace for more information.  The semaphore
+    * profiler takes its place when built with SEM_PROFILER=1. */
+    #if ( projSEM_PROFILER != 1 )
+        vTraceEnable( TRC_START );
+        uiTraceStart();
+    #endif
     
     console_init();
+    console_set_mode( xDemoConfig.xConsoleMode );
+
+    if( ( xDemoConfig.pcBinaryLogPath != NULL ) &&
+        ( console_set_binary_file( xDemoConfig.pcBinaryLogPath ) != 0 ) )
+    {
+        fprintf( stderr, "Cannot create the binary log %s\n", xDemoConfig.pcBinaryLogPath );
+        return 1;
+    }
+
+    if( ( xDemoConfig.pcLogFilePath != NULL ) &&
+        ( console_set_log_file( xDemoConfig.pcLogFilePath, ( size_t ) xDemoConfig.ulLogSizeKb * 1024U ) != 0 ) )
+    {
+        perror( xDemoConfig.pcLogFilePath );
+        return 1;
+    }
+
+    if( ( xDemoConfig.pcCpuLogPath != NULL ) &&
+        ( xCpuSamplerStart( xDemoConfig.pcCpuLogPath, xDemoConfig.ulCpuIntervalMs ) != pdPASS ) )
+    {
+        perror( xDemoConfig.pcCpuLogPath );
+        return 1;
+    }
+
     console_print( "Starting 'Semaphores: This is fun! Part 1'\n" );
 
-    /* Call the function creating the examples for semaphores - Task1 and Task2 */
-    main_semaphores();
-    main_readers_writer();
+    /* Done once, before any task runs, so that the critical section lengths
+     * given in microseconds do not depend on the optimisation level. */
+    vWorkCalibrate();
+    console_print( "Work calibration: %llu units per ms\n", ( unsigned long long ) ullWorkUnitsPerMs() );
+
+    /* Call the function creating the selected example - both start the
+     * scheduler, so only one of them can run. */
+    if( xDemoConfig.xDemo == eDemoReadersWriter )
+    {
+        main_readers_writer();
+    }
+    else if( xDemoConfig.xDemo == eDemoPriorityInversion )
+    {
+        main_priority_inversion();
+    }
+    else
+    {
+        /* The examples for semaphores - Task1 and Task2 */
+        main_semaphores();
+    }
+
+    /* The scheduler has ended - write out what the flusher task left */
+    vSemProfilerReport();
+    console_flush();
+    prvReportConsole();
+    vCpuSamplerClose();
 
     return 0;
 }
 /*-----------------------------------------------------------*/
 
+/* Reports the console messages that were dropped, delayed or truncated, if
+ * any - called once the scheduler has ended and the console is flushed. */
+static void prvReportConsole( void )
+{
+    ConsoleStats_t xStats;
+
+    console_get_stats( &xStats );
+
+    if( ( xStats.ulDropped > 0 ) || ( xStats.ulBlocked > 0 ) || ( xStats.ulTruncated > 0 ) )
+    {
+        printf( "Console (%s): %lu record(s) in %lu write(s), %lu dropped, %lu waited for space, %lu truncated\n",
+                console_mode_name( xDemoConfig.xConsoleMode ),
+                ( unsigned long ) xStats.ulRecords, ( unsigned long ) xStats.ulWrites,
+                ( unsigned long ) xStats.ulDropped, ( unsigned long ) xStats.ulBlocked,
+                ( unsigned long ) xStats.ulTruncated );
+    }
+}
+/*-----------------------------------------------------------*/
+
 void vApplicationMallocFailedHook( void )
 {
     /* vApplicationMallocFailedHook() will only be called if
@@ -167,6 +250,9 @@ void vApplicationIdleHook( void )
     usleep( 15000 );
     traceOnEnter();
 
+    /* Frees what the readers-writer demo no longer publishes, if anything */
+    vRcuIdleHook();
+
 }
 /*-----------------------------------------------------------*/
 
@@ -196,7 +282,7 @@ void vApplicationTickHook( void )
 
 void traceOnEnter()
 {
-    #if ( TRACE_ON_ENTER == 1 )
+    #if ( TRACE_ON_ENTER == 1 ) || ( projSEM_PROFILER == 1 )
         int xReturn;
         struct timeval tv = { 0L, 0L };
         fd_set fds;
@@ -208,16 +294,21 @@ void traceOnEnter()
 
         if( xReturn > 0 )
         {
-            if( xTraceRunning == pdTRUE )
-            {
-                prvSaveTraceFile();
-            }
+            #if ( projSEM_PROFILER == 1 )
+                /* The idle task must not block on the console. */
+                vSemProfilerRequestReport();
+            #else
+                if( xTraceRunning == pdTRUE )
+                {
+                    prvSaveTraceFile();
+                }
+            #endif
 
             /* clear the buffer */
             char buffer[ 0 ];
             read( STDIN_FILENO, &buffer, 1 );
         }
-    #endif /* if ( TRACE_ON_ENTER == 1 ) */
+    #endif /* if ( TRACE_ON_ENTER == 1 ) || ( projSEM_PROFILER == 1 ) */
 }
 
 void vLoggingPrintf( const char * pcFormat,
@@ -225,8 +316,9 @@ void vLoggingPrintf( const char * pcFormat,
 {
     va_list arg;
 
+    /* The same path as the demo's own messages - see console.h */
     va_start( arg, pcFormat );
-    vprintf( pcFormat, arg );
+    console_vprint( pcFormat, arg );
     va_end( arg );
 }
 /*-----------------------------------------------------------*/
@@ -237,6 +329,9 @@ void vApplicationDaemonTaskStartupHook( void )
      * execute    (sometimes called the timer task).  This is useful if the
      * application includes initialisation code that would benefit from executing
      * after the scheduler has been started. */
+
+    /* The run time counter was set up by vTaskStartScheduler() */
+    console_print( "Run time counter: %s clock, in %s\n", pcRunTimeClockName(), runtimeUNIT_NAME );
 }
 /*-----------------------------------------------------------*/
 
@@ -282,8 +377,9 @@ void vAssertCalled( const char * const pcFileName,
 
 static void prvSaveTraceFile( void )
 {
-    /* Tracing is not used when code coverage analysis is being performed. */
-    #if ( projCOVERAGE_TEST != 1 )
+    /* Tracing is not used when code coverage analysis is being performed, nor
+     * with the semaphore profiler. */
+    #if ( projCOVERAGE_TEST != 1 ) && ( projSEM_PROFILER != 1 )
         {
             FILE * pxOutputFile;
 
@@ -302,7 +398,7 @@ static void prvSaveTraceFile( void )
                 printf( "\r\nFailed to create trace dump file\r\n" );
             }
         }
-    #endif /* if ( projCOVERAGE_TEST != 1 ) */
+    #endif /* if ( projCOVERAGE_TEST != 1 ) && ( projSEM_PROFILER != 1 ) */
 }
 /*-----------------------------------------------------------*/
 
@@ -360,5 +456,7 @@ void vApplicationGetTimerTaskMemory( StaticTask_t ** ppxTimerTaskTCBBuffer,
 
 void handle_sigint( int signal )
 {
+    /* Whatever the console wrote to --log-file is in the page cache already,
+     * and stays in the file - only what is still queued is lost. */
     exit( 2 );
 }
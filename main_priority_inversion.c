@@ -0,0 +1,288 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/******************************************************************************
+ * NOTE 1: The FreeRTOS demo threads will not be running continuously, so
+ * do not expect to get real time behaviour from the FreeRTOS Linux port, or
+ * this demo application.  Also, the timing information in the FreeRTOS+Trace
+ * logs have no meaningful units.  See the documentation page for the Linux
+ * port for further information:
+ * https://freertos.org/FreeRTOS-simulator-for-Linux.html
+ *
+ * NOTE 2: The scenario below is the textbook priority inversion.  Every
+ * PERIOD:
+ * - the low priority task takes the resource and works with it for
+ *   --cs-length microseconds (LOW_HOLD_US by default);
+ * - one tick later the high priority task needs the resource too, and blocks;
+ * - one more tick later the medium priority task, which never touches the
+ *   resource, burns MEDIUM_BURN_US of CPU.
+ * With a binary semaphore the medium task preempts the holder, and the high
+ * priority task waits for both.  With a mutex the holder inherits the high
+ * priority, so the high priority task only waits for the end of the critical
+ * section.  The time the high priority task is blocked is recorded for both.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "console.h"
+#include "demo_config.h"
+#include "latency_histogram.h"
+#include "run_time_stats.h"
+#include "work_units.h"
+
+/* Priorities at which the tasks are created. */
+#define LOW_PRIORITY           ( tskIDLE_PRIORITY + 1 )
+#define MEDIUM_PRIORITY        ( tskIDLE_PRIORITY + 2 )
+#define HIGH_PRIORITY          ( tskIDLE_PRIORITY + 3 )
+#define SUPERVISOR_PRIORITY    ( configMAX_PRIORITIES - 1 )
+
+/* Release times of the tasks within the period. */
+#define PERIOD                 pdMS_TO_TICKS( 50UL )
+#define HIGH_OFFSET            pdMS_TO_TICKS( 1UL )
+#define MEDIUM_OFFSET          pdMS_TO_TICKS( 2UL )
+
+/* Work done by the tasks, in microseconds. */
+#define LOW_HOLD_US            ( 5000UL )
+#define MEDIUM_BURN_US         ( 20000UL )
+#define HIGH_HOLD_US           ( 100UL )
+
+/* Run time per primitive when no --duration is given. */
+#define DEFAULT_RUN_SECONDS    ( 5UL )
+
+#define TASK_STACK_SIZE        ( 1000UL )
+
+/*-----------------------------------------------------------*/
+
+static void prvLowTask( void * pvParameters );
+static void prvMediumTask( void * pvParameters );
+static void prvHighTask( void * pvParameters );
+static void prvSupervisorTask( void * pvParameters );
+
+/* The resource shared by the low and the high priority tasks. */
+static SemaphoreHandle_t resource = 0;
+
+/* Given by every task once it has left its loop. */
+static SemaphoreHandle_t tasksDone = 0;
+
+static volatile BaseType_t scenarioRunning = pdFALSE;
+static TaskHandle_t scenarioTasks[ 3 ];
+
+/* Start of the first period, shared so that the offsets line up. */
+static TickType_t scenarioStart = 0;
+
+/* Time the high priority task spent blocked on the resource, per primitive:
+ * index 0 is the binary semaphore, index 1 the mutex. */
+static LatencyHistogram_t blocking[ 2 ];
+
+/*-----------------------------------------------------------*/
+
+void main_priority_inversion( void )
+{
+    tasksDone = xSemaphoreCreateCounting(3, 0);
+
+    xTaskCreate( prvSupervisorTask,
+                 "Supervisor",
+                 TASK_STACK_SIZE,
+                 NULL,
+                 SUPERVISOR_PRIORITY,
+                 NULL );
+
+    /* Start the tasks and timer running. */
+    vTaskStartScheduler();
+
+    /* The scheduler only returns once the supervisor has ended it, or when
+     * there was insufficient FreeRTOS heap memory available for the idle
+     * and/or timer tasks to be created. */
+}
+/*-----------------------------------------------------------*/
+
+static void runScenario( BaseType_t useMutex, TickType_t runTicks )
+{
+    vHistogramReset(&blocking[ useMutex ]);
+
+    if (useMutex)
+    {
+        resource = xSemaphoreCreateMutex();
+    }
+    else
+    {
+        /* Binary semaphores start empty */
+        resource = xSemaphoreCreateBinary();
+        xSemaphoreGive(resource);
+    }
+
+    configASSERT(resource);
+
+    /* The tasks start together on the next tick */
+    scenarioStart = xTaskGetTickCount() + 1;
+    scenarioRunning = pdTRUE;
+
+    xTaskCreate(prvLowTask, "Low", TASK_STACK_SIZE, NULL, LOW_PRIORITY, &scenarioTasks[ 0 ]);
+    xTaskCreate(prvMediumTask, "Medium", TASK_STACK_SIZE, NULL, MEDIUM_PRIORITY, &scenarioTasks[ 1 ]);
+    xTaskCreate(prvHighTask, "High", TASK_STACK_SIZE, &blocking[ useMutex ], HIGH_PRIORITY, &scenarioTasks[ 2 ]);
+
+    vTaskDelay(runTicks);
+
+    /* Wake the tasks up so that they notice the end of the run */
+    scenarioRunning = pdFALSE;
+
+    for (int x = 0; x < 3; x++)
+    {
+        xTaskAbortDelay(scenarioTasks[ x ]);
+    }
+
+    for (int x = 0; x < 3; x++)
+    {
+        xSemaphoreTake(tasksDone, portMAX_DELAY);
+    }
+
+    vSemaphoreDelete(resource);
+    resource = 0;
+
+    /* Give the idle task a chance to free the deleted tasks */
+    vTaskDelay(PERIOD);
+}
+/*-----------------------------------------------------------*/
+
+static void prvSupervisorTask( void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    static const char * const names[ 2 ] = { "binary", "mutex" };
+    static const char * const inheritance[ 2 ] = { "no", "yes" };
+    uint32_t seconds = (xDemoConfig.ulRunSeconds > 0) ? xDemoConfig.ulRunSeconds : DEFAULT_RUN_SECONDS;
+
+    console_print("\nPriority inversion: low holds %lu us, medium burns %lu us, every %lu ms\n",
+                  (unsigned long) ((xDemoConfig.ulCriticalSectionLength > 0) ? xDemoConfig.ulCriticalSectionLength : LOW_HOLD_US),
+                  (unsigned long) MEDIUM_BURN_US,
+                  (unsigned long) (PERIOD * portTICK_PERIOD_MS));
+
+    runScenario(pdFALSE, (TickType_t) seconds * configTICK_RATE_HZ);
+    runScenario(pdTRUE, (TickType_t) seconds * configTICK_RATE_HZ);
+
+    console_print("\nBlocking of the high priority task - times in run time counter units (" runtimeUNIT_NAME ")\n");
+    console_print("%-8s %11s %8s %10s %10s %10s %10s\n",
+                  "Resource", "Inheritance", "Takes", "Block avg", "p50", "p99", "max");
+
+    for (int x = 0; x < 2; x++)
+    {
+        console_print("%-8s %11s %8llu %10llu %10llu %10llu %10llu\n",
+                      names[ x ],
+                      inheritance[ x ],
+                      (unsigned long long) blocking[ x ].ullCount,
+                      (unsigned long long) ullHistogramMean(&blocking[ x ]),
+                      (unsigned long long) ullHistogramPercentile(&blocking[ x ], 50.0),
+                      (unsigned long long) ullHistogramPercentile(&blocking[ x ], 99.0),
+                      (unsigned long long) blocking[ x ].ullMax);
+    }
+
+    /* main_priority_inversion() returns once the scheduler is ended */
+    vTaskEndScheduler();
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void taskDone( void )
+{
+    xSemaphoreGive(tasksDone);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void prvLowTask( void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    uint32_t holdUs = (xDemoConfig.ulCriticalSectionLength > 0) ? xDemoConfig.ulCriticalSectionLength : LOW_HOLD_US;
+    TickType_t wakeTime = scenarioStart;
+
+    while (scenarioRunning == pdTRUE)
+    {
+        xTaskDelayUntil(&wakeTime, PERIOD);
+
+        if (xSemaphoreTake(resource, portMAX_DELAY))
+        {
+            vWorkBurnUs(holdUs);
+            xSemaphoreGive(resource);
+        }
+    }
+
+    taskDone();
+}
+/*-----------------------------------------------------------*/
+
+static void prvMediumTask( void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    TickType_t wakeTime = scenarioStart + MEDIUM_OFFSET;
+
+    while (scenarioRunning == pdTRUE)
+    {
+        xTaskDelayUntil(&wakeTime, PERIOD);
+
+        /* Nothing to do with the resource - only delays whoever runs below */
+        vWorkBurnUs(MEDIUM_BURN_US);
+    }
+
+    taskDone();
+}
+/*-----------------------------------------------------------*/
+
+static void prvHighTask( void * pvParameters )
+{
+    LatencyHistogram_t * histogram = (LatencyHistogram_t *) pvParameters;
+    TickType_t wakeTime = scenarioStart + HIGH_OFFSET;
+
+    while (scenarioRunning == pdTRUE)
+    {
+        xTaskDelayUntil(&wakeTime, PERIOD);
+
+        unsigned long start = ulGetRunTimeCounterValue();
+
+        /* The supervisor aborts the wait at the end of the run */
+        if (xSemaphoreTake(resource, portMAX_DELAY))
+        {
+            /* Only this task records into the histogram */
+            vHistogramRecord(histogram, ulGetRunTimeCounterValue() - start);
+            vWorkBurnUs(HIGH_HOLD_US);
+            xSemaphoreGive(resource);
+        }
+    }
+
+    taskDone();
+}
+/*-----------------------------------------------------------*/
@@ -36,9 +36,50 @@
  * interfere with the execution of the FreeRTOS Linux port. This demo only
  * uses Linux system call occasionally. Heavier use of Linux system calls
  * may crash the port.
+ *
+ * NOTE 2: The readers and the writer share the newspaper through newsSpace, a
+ * readers-writer lock (rw_lock.c) whose policy is selected with --rw-policy.
+ * The reader count the readers used to keep under `mutex` lives inside the
+ * lock, next to the mutex that protects it.  --bench=rwlock replaces the
+ * readers and the writer by --tasks tasks that read or write back to back,
+ * and compares the throughput of the policies at several read/write ratios.
+ *
+ * NOTE 3: With --rw-policy big-reader, newsSpace is a big-reader lock
+ * (big_reader_lock.c) instead: each reader counts itself in a slot of its
+ * own, and only the writer looks at all of them.  --bench=brlock compares the
+ * read throughput of the locks from 4 to 256 readers.
+ *
+ * NOTE 4: With --rw-policy rcu, readers do not lock at all (rcu.c): the writer
+ * builds the next edition of the newspaper in a copy and publishes it by
+ * swapping the newspaper pointer.  Readers keep the edition they started
+ * with, and the editions nobody reads any more are freed from the idle hook
+ * - or, when benchmarking keeps the idle task from running, from a grace
+ * period task.
+ *
+ * NOTE 5: Writers that read the newspaper to decide whether to change it can
+ * take an upgradable read lock and upgrade it only to write, so that the
+ * readers are kept out for the change alone.  --bench=upgrade compares the
+ * exclusive hold time with the write lock taken up front, as prvWriter does.
+ *
+ * NOTE 6: When changes arrive faster than the readers drain, taking the write
+ * lock for each of them keeps the readers out again and again.  A batching
+ * front end (write_batcher.c) lets producers queue their changes without
+ * blocking, and a single writer applies all the pending ones in one exclusive
+ * section.  --bench=coalesce compares the reader blocking of both.
+ *
+ * NOTE 7: --bench=workload drives the newspaper with --readers readers and
+ * --writers writers instead of the fixed READER_FREQUENCY_MS and
+ * WRITER_FREQUENCY_MS: together they offer --op-rate operations per second,
+ * --read-percent of them reads, each holding the lock for --cs-length.  Each
+ * task runs the operations that are due every tick, and skips - counts as
+ * missed - those it has fallen too far behind on, so that an overloaded lock
+ * shows as a drop in throughput rather than as an ever growing backlog.
+ * Throughput and latency percentiles are sampled every second, printed and,
+ * with --csv, written to a file for plotting.
  */
 
 #include <stdio.h>
+#include <errno.h>
 #include <pthread.h>
 #include <string.h>
 
@@ -52,10 +93,21 @@
 
 /* Local includes. */
 #include "console.h"
+#include "demo_config.h"
+#include "latency_histogram.h"
+#include "rw_lock.h"
+#include "big_reader_lock.h"
+#include "rcu.h"
+#include "run_time_stats.h"
+#include "starvation_monitor.h"
+#include "work_units.h"
+#include "write_batcher.h"
+#include "sem_profiler.h"
 
 /* Priorities at which the tasks are created. */
 #define READER_PRIORITY    ( tskIDLE_PRIORITY + 1 )
 #define WRITER_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#define SUPERVISOR_PRIORITY    ( configMAX_PRIORITIES - 1 )
 
 /* The rate at which data is sent to the queue.  The times are converted from
  * milliseconds to ticks using the pdMS_TO_TICKS() macro. */
@@ -68,9 +120,62 @@
  * queue send software timer respectively. */
 #define READER_STACK_SIZE        ( 1000UL )
 #define WRITER_STACK_SIZE        ( 1000UL )
+#define SUPERVISOR_STACK_SIZE    ( 1000UL )
+#define BENCH_STACK_SIZE         ( 1000UL )
+
+/* Reader statistics - the RAM of the reader pool and the stack the readers
+ * left unused - are printed every READER_REPORT_ATTEMPTS writer attempts. */
+#define READER_REPORT_ATTEMPTS   ( 4UL * WRITER_REPORT_ATTEMPTS )
+
+/* Read/write ratios of the benchmark, as the percentage of reads, and how
+ * long its tasks wait for the lock before checking whether the run is over. */
+#define BENCH_READ_PERCENTS      { 50, 80, 95, 99 }
+#define BENCH_RATIO_COUNT        ( 4 )
+#define BENCH_LOCK_TIMEOUT       A_100_MS_DELAY
 
-/* Activation of semaphore patterns - only one at a time can be active  */
-#undef PRIORITIZED_WRITER 
+/* Reader counts of the big-reader benchmark, whose writer writes every
+ * SCALING_WRITE_PERIOD. */
+#define SCALING_MIN_READERS      ( 4U )
+#define SCALING_MAX_READERS      ( 256U )
+#define SCALING_RUN_COUNT        ( 3 * 7 )
+#define SCALING_WRITE_PERIOD     pdMS_TO_TICKS( 10UL )
+#define BENCH_MAX_TASKS          ( demoMAX_READERS + demoMAX_WORKER_TASKS )
+
+/* The upgrade benchmark: UPGRADE_DECIDERS writers decide, every
+ * UPGRADE_DECIDE_PERIOD, whether to change the newspaper, and do so
+ * UPGRADE_CHANGE_PERCENT percent of the time. */
+#define UPGRADE_DECIDERS         ( 2U )
+#define UPGRADE_DECIDE_PERIOD    pdMS_TO_TICKS( 1UL )
+#define UPGRADE_CHANGE_PERCENT   ( 25U )
+#define UPGRADE_RUN_COUNT        ( eRwLockPolicyCount * 2 )
+
+/* The coalescing benchmark: COALESCE_PRODUCERS producers change the newspaper
+ * every COALESCE_PERIOD each.  Up to COALESCE_QUEUE_LENGTH batched changes
+ * can be pending. */
+#define COALESCE_PRODUCERS       ( 4U )
+#define COALESCE_PERIOD          pdMS_TO_TICKS( 1UL )
+#define COALESCE_QUEUE_LENGTH    ( 64U )
+#define COALESCE_RUN_COUNT       ( eRwLockPolicyCount * 2 )
+#define BATCHER_PRIORITY         ( WRITER_PRIORITY + 1 )
+
+/* The workload generator: results are sampled every WORKLOAD_SAMPLE_PERIOD,
+ * and a task falling more than WORKLOAD_MAX_BACKLOG operations behind skips
+ * them. */
+#define WORKLOAD_SAMPLE_PERIOD   pdMS_TO_TICKS( 1000UL )
+#define WORKLOAD_MAX_BACKLOG     ( 100ULL )
+#define WORKLOAD_RUN_COUNT       ( eRwLockPolicyCount + 2 )
+
+/* The writer is starved - an update pending - for longer than this, unless
+ * --starvation-ms says otherwise.  Its statistics are printed every
+ * WRITER_REPORT_ATTEMPTS attempts. */
+#define WRITER_STARVATION_MS      ( 3UL * 20000UL )
+#define BENCH_STARVATION_MS       ( 1000UL )
+#define WRITER_REPORT_ATTEMPTS    ( 15UL )
+
+/* How often the grace period task frees the editions of the newspaper
+ * nobody reads any more */
+#define GRACE_PERIOD             pdMS_TO_TICKS( 10UL )
+#define GRACE_PERIOD_PRIORITY    ( READER_PRIORITY + 1 )
 
 /*-----------------------------------------------------------*/
 
@@ -80,51 +185,488 @@
 static void prvReader( void * pvParameters );
 static void prvWriter( void * pvParameters );
 
+/*
+ * The benchmark - the supervisor runs each policy and ratio in turn with
+ * --tasks benchmark tasks.
+ */
+static void prvSupervisorTask( void * pvParameters );
+static void prvBenchTask( void * pvParameters );
+static void prvScalingReaderTask( void * pvParameters );
+static void prvScalingWriterTask( void * pvParameters );
+static void prvGracePeriodTask( void * pvParameters );
+static void prvDeciderTask( void * pvParameters );
+static void prvProducerTask( void * pvParameters );
+static void prvWorkloadTask( void * pvParameters );
+
 
-/* No matter the pattern, the type is always the same */
-static SemaphoreHandle_t newsSpace = 0;
-static SemaphoreHandle_t mutex     = 0;
+/* The readers-writer lock of the newspaper - its internal mutex plays the
+ * part of the former `mutex`, protecting the reader count */
+static RwLock_t newsSpace;
+
+/* newsSpace when the big-reader lock is used - see the NOTE 3 above */
+static BigReaderLock_t newsSlots;
+
+/* The editions of the newspaper with --rw-policy rcu - see the NOTE 4
+ * above.  Writers still exclude each other with newsUpdaters. */
+static RcuDomain_t newsVersions;
+static SemaphoreHandle_t newsUpdaters = 0;
+static TaskHandle_t gracePeriodTask = NULL;
+static volatile BaseType_t gracePeriodRunning = pdFALSE;
+
+static NewsLock_t newsLock = eNewsRwLock;
+
+/* The readers of the demo, --readers of them, from a statically allocated
+ * pool so that their count does not depend on the FreeRTOS heap.  Each
+ * reader gets its number as task parameter. */
+static StaticTask_t readerTcbs[ demoMAX_READERS ];
+static StackType_t readerStacks[ demoMAX_READERS ][ READER_STACK_SIZE ];
+static TaskHandle_t readerTasks[ demoMAX_READERS ];
 
 /*-----------------------------------------------------------*/
 /* Maximum size of variable*/
 #define MAX_STRING_SIZE ( 64UL )
 
+/* The newspaper itself, only changed with newsSpace held for writing -
+ * or replaced by a new edition with --rw-policy rcu */
+typedef struct Newspaper
+{
+    uint32_t edition;
+    char text[ MAX_STRING_SIZE ];
+} Newspaper_t;
+
+static Newspaper_t * newspaper = NULL;
+
+/* Attempts of the writer(s) to update the newspaper - see
+ * starvation_monitor.h */
+static StarvationMonitor_t writerStarvation;
+
+/* Benchmark state, see prvSupervisorTask() */
+static volatile BaseType_t benchRunning = pdFALSE;
+static uint32_t benchReadPercent = 0;
+static TaskHandle_t benchTasks[ BENCH_MAX_TASKS ];
+static SemaphoreHandle_t benchDone = 0;
+
+/* Updated by the benchmark tasks inside a critical section */
+typedef struct BenchStats
+{
+    uint32_t reads;
+    uint32_t writes;
+    LatencyHistogram_t readWait;  /* Read lock called -> obtained. */
+    LatencyHistogram_t writeWait; /* Write lock called -> obtained. */
+} BenchStats_t;
+
+static BenchStats_t benchStats;
+
+typedef struct BenchResult
+{
+    const char * lock;
+    uint32_t readPercent;
+    double readsPerSecond;
+    double writesPerSecond;
+    uint64_t readWaitP50;
+    uint64_t readWaitP99;
+    uint64_t writeWaitP50;
+    uint64_t writeWaitP99;
+    uint64_t writeWaitMax;
+    uint32_t writeSkips;   /* Write attempts that timed out. */
+    uint64_t ageP99;       /* Time between two updates. */
+    uint32_t alarms;
+} BenchResult_t;
+
+static BenchResult_t benchResults[ eRwLockPolicyCount * BENCH_RATIO_COUNT ];
+
+/* Big-reader benchmark: reads of each reader, only written by the reader
+ * itself, and waits of the writer, only recorded by the writer */
+static uint32_t scalingReads[ SCALING_MAX_READERS ];
+static uint32_t scalingWrites = 0;
+static LatencyHistogram_t scalingWriteWait;
+
+typedef struct ScalingResult
+{
+    const char * lock;
+    UBaseType_t readers;
+    double readsPerSecond;
+    uint32_t writes;
+    uint64_t writeWaitP50;
+    uint64_t writeWaitP99;
+    uint64_t writeWaitMax;
+} ScalingResult_t;
+
+static ScalingResult_t scalingResults[ SCALING_RUN_COUNT ];
+
+/* Upgrade benchmark: the deciders record into upgradeStats inside a critical
+ * section, the readers count their reads in scalingReads */
+static BaseType_t upgradeDecide = pdFALSE;
+
+typedef struct UpgradeStats
+{
+    uint32_t decisions;
+    uint32_t changes;
+    uint32_t skips;                    /* Lock or upgrade not obtained in time. */
+    uint64_t exclusiveTotal;
+    LatencyHistogram_t exclusiveHold;  /* Write lock obtained -> released. */
+} UpgradeStats_t;
+
+static UpgradeStats_t upgradeStats;
+
+typedef struct UpgradeResult
+{
+    const char * lock;
+    BaseType_t upgradable;
+    double decisionsPerSecond;
+    double readsPerSecond;
+    uint32_t changes;
+    uint32_t skips;
+    uint64_t holdP50;
+    uint64_t holdP99;
+    uint64_t holdMax;
+    double exclusivePercent;           /* Of the run time. */
+} UpgradeResult_t;
+
+static UpgradeResult_t upgradeResults[ UPGRADE_RUN_COUNT ];
+
+/* Coalescing benchmark: the producers either take the write lock for each
+ * change, counting into coalesceDirect* inside a critical section, or queue
+ * it in newsBatcher.  The readers record their waits into benchStats. */
+typedef struct NewsChange
+{
+    uint32_t producer;
+    uint32_t sequence;
+} NewsChange_t;
+
+static WriteBatcher_t newsBatcher;
+static BaseType_t coalesceBatched = pdFALSE;
+static uint32_t coalesceDirectChanges = 0;
+static uint32_t coalesceDirectSkips = 0;
+
+typedef struct CoalesceResult
+{
+    const char * lock;
+    BaseType_t batched;
+    double changesPerSecond;
+    uint32_t acquisitions;     /* Of the write lock. */
+    double mergedPerAcquisition;
+    uint64_t mergedMax;
+    uint32_t dropped;          /* Changes not applied. */
+    double readsPerSecond;
+    uint64_t readWaitP50;
+    uint64_t readWaitP99;
+    uint64_t readBlockedUs;    /* Sum of the read waits. */
+} CoalesceResult_t;
+
+static CoalesceResult_t coalesceResults[ COALESCE_RUN_COUNT ];
+
+/* Workload generator: the tasks record into workloadStats inside a critical
+ * section, the supervisor takes it over every second.  Latencies run from
+ * the lock call to the unlock. */
+typedef struct WorkloadStats
+{
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t missed;     /* Operations skipped by tasks too far behind. */
+    uint32_t timeouts;   /* Lock not obtained within BENCH_LOCK_TIMEOUT. */
+    LatencyHistogram_t readLatency;
+    LatencyHistogram_t writeLatency;
+} WorkloadStats_t;
+
+static WorkloadStats_t workloadStats;
+static WorkloadStats_t workloadSample;
+static WorkloadStats_t workloadTotal;
+static unsigned long workloadStart = 0;
+
+typedef struct WorkloadResult
+{
+    const char * lock;
+    double readsPerSecond;
+    double writesPerSecond;
+    uint32_t missed;
+    uint32_t timeouts;
+    uint64_t readP50;
+    uint64_t readP99;
+    uint64_t writeP50;
+    uint64_t writeP99;
+} WorkloadResult_t;
+
+static WorkloadResult_t workloadResults[ WORKLOAD_RUN_COUNT ];
+
+/*-----------------------------------------------------------*/
+
+static const char * newsLockName( void )
+{
+    if (newsLock == eNewsBigReader)
+    {
+        return "big-reader";
+    }
+
+    return (newsLock == eNewsRcu) ? "rcu" : pcRwLockPolicyName(newsSpace.xPolicy);
+}
+/*-----------------------------------------------------------*/
+
+/* The editions are freed by the RCU domain */
+static void freeNewspaper( void * edition )
+{
+    vPortFree(edition);
+}
+/*-----------------------------------------------------------*/
+
+static void createNewsLock( NewsLock_t lock, RwLockPolicy_t policy, UBaseType_t readers )
+{
+    newsLock = lock;
+    newspaper = pvPortMalloc(sizeof(Newspaper_t));
+    configASSERT(newspaper);
+    newspaper->edition = 0;
+    snprintf(newspaper->text, sizeof(newspaper->text), "Edition 0");
+
+    if (lock == eNewsBigReader)
+    {
+        vBigReaderLockInit(&newsSlots, (readers < brlockMAX_SLOTS) ? readers : brlockMAX_SLOTS);
+    }
+    else if (lock == eNewsRcu)
+    {
+        vRcuInit(&newsVersions, (readers < rcuMAX_READERS) ? readers : rcuMAX_READERS, freeNewspaper);
+        newsUpdaters = xSemaphoreCreateMutex();
+        vSemProfilerRegister(newsUpdaters, "newsUpdaters");
+
+        /* The benchmarks keep the idle task from running */
+        if (xDemoConfig.xBench == eBenchNone)
+        {
+            vRcuReclaimFromIdle(&newsVersions);
+        }
+        else
+        {
+            gracePeriodRunning = pdTRUE;
+            xTaskCreate(prvGracePeriodTask, "GracePeriod", BENCH_STACK_SIZE, NULL, GRACE_PERIOD_PRIORITY, &gracePeriodTask);
+        }
+    }
+    else
+    {
+        vRwLockInit(&newsSpace, policy);
+        vSemProfilerRegister(newsSpace.xMutex, "newsSpace.mutex");
+        vSemProfilerRegister(newsSpace.xReadersGo, "newsSpace.readers");
+        vSemProfilerRegister(newsSpace.xWriterGo, "newsSpace.writer");
+        vSemProfilerRegister(newsSpace.xUpgraderGo, "newsSpace.upgrader");
+        vSemProfilerRegister(newsSpace.xUpgradeGo, "newsSpace.upgrade");
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Called once the readers and the writers are gone */
+static void deleteNewsLock( void )
+{
+    if (newsLock == eNewsBigReader)
+    {
+        vBigReaderLockDelete(&newsSlots);
+    }
+    else if (newsLock == eNewsRcu)
+    {
+        if (gracePeriodTask != NULL)
+        {
+            gracePeriodRunning = pdFALSE;
+            xTaskAbortDelay(gracePeriodTask);
+            xSemaphoreTake(benchDone, portMAX_DELAY);
+            gracePeriodTask = NULL;
+        }
+
+        vRcuDelete(&newsVersions);
+        vSemaphoreDelete(newsUpdaters);
+    }
+    else
+    {
+        vRwLockDelete(&newsSpace);
+    }
+
+    vPortFree(newspaper);
+    newspaper = NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* The reader number selects the slot of the big-reader lock, or of the RCU
+ * domain */
+static BaseType_t readLockNews( UBaseType_t reader, TickType_t ticksToWait )
+{
+    if (newsLock == eNewsBigReader)
+    {
+        return xBigReaderReadLock(&newsSlots, reader, ticksToWait);
+    }
+
+    if (newsLock == eNewsRcu)
+    {
+        /* Never waits */
+        vRcuReadLock(&newsVersions, reader);
+        return pdTRUE;
+    }
+
+    return xRwLockReadLock(&newsSpace, ticksToWait);
+}
+/*-----------------------------------------------------------*/
+
+static void readUnlockNews( UBaseType_t reader )
+{
+    if (newsLock == eNewsBigReader)
+    {
+        vBigReaderReadUnlock(&newsSlots, reader);
+    }
+    else if (newsLock == eNewsRcu)
+    {
+        vRcuReadUnlock(&newsVersions, reader);
+    }
+    else
+    {
+        vRwLockReadUnlock(&newsSpace);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t writeLockNews( TickType_t ticksToWait )
+{
+    if (newsLock == eNewsBigReader)
+    {
+        return xBigReaderWriteLock(&newsSlots, ticksToWait);
+    }
+
+    if (newsLock == eNewsRcu)
+    {
+        /* Only excludes the other writers */
+        return xSemaphoreTake(newsUpdaters, ticksToWait);
+    }
+
+    return xRwLockWriteLock(&newsSpace, ticksToWait);
+}
+/*-----------------------------------------------------------*/
+
+static void writeUnlockNews( void )
+{
+    if (newsLock == eNewsBigReader)
+    {
+        vBigReaderWriteUnlock(&newsSlots);
+    }
+    else if (newsLock == eNewsRcu)
+    {
+        xSemaphoreGive(newsUpdaters);
+    }
+    else
+    {
+        vRwLockWriteUnlock(&newsSpace);
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* The edition to read, between readLockNews() and readUnlockNews() */
+static const Newspaper_t * currentNewspaper( void )
+{
+    return pvRcuDereference(&newspaper);
+}
+/*-----------------------------------------------------------*/
+
+/* Writes the next edition, with the write lock held - csUnits of work are
+ * spent writing it */
+static void updateNewspaper( uint64_t csUnits )
+{
+    Newspaper_t * next = newspaper;
+
+    /* Readers may still be reading the current edition - write a copy */
+    if (newsLock == eNewsRcu)
+    {
+        next = pvPortMalloc(sizeof(Newspaper_t));
+        configASSERT(next);
+        *next = *newspaper;
+    }
 
+    vWorkBurnUnits(csUnits);
+    next->edition++;
+    snprintf(next->text, sizeof(next->text), "Edition %lu", (unsigned long) next->edition);
+
+    if (newsLock == eNewsRcu)
+    {
+        vRcuPublish(&newsVersions, (void **) &newspaper, next);
+    }
+}
 /*-----------------------------------------------------------*/
 
 void changeContentOfNewspaper(void)
 {
-    /* Let's reset the content of the destination to '\0' - so no need to set it later*/
-    printf("\t\tWriter just changed the content\n");
+    /* Called with newsSpace held for writing - nobody reads in the meantime */
+    updateNewspaper(0);
+    console_print("\t\tWriter just changed the content\n");
+}
+/*-----------------------------------------------------------*/
+
+/* How far the reader population scales: the RAM each reader takes from the
+ * pool, and how much of its stack the readers have left unused so far */
+static void reportReaderMemory( UBaseType_t readers )
+{
+    size_t stackBytes = READER_STACK_SIZE * sizeof(StackType_t);
+    size_t perReader = sizeof(StaticTask_t) + stackBytes;
+
+    console_print("Readers: %u of %u, %lu bytes each (TCB %lu + stack %lu), %lu bytes in all\n",
+                  (unsigned) readers, (unsigned) demoMAX_READERS,
+                  (unsigned long) perReader, (unsigned long) sizeof(StaticTask_t),
+                  (unsigned long) stackBytes, (unsigned long) (readers * perReader));
+    console_print("Allocated from the FreeRTOS heap instead, configTOTAL_HEAP_SIZE (%lu bytes) would hold %lu readers\n",
+                  (unsigned long) configTOTAL_HEAP_SIZE, (unsigned long) (configTOTAL_HEAP_SIZE / perReader));
+
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+    {
+        UBaseType_t minUnused = READER_STACK_SIZE;
+
+        for (UBaseType_t i = 0; i < readers; i++)
+        {
+            UBaseType_t unused = uxTaskGetStackHighWaterMark(readerTasks[i]);
+
+            if (unused < minUnused)
+            {
+                minUnused = unused;
+            }
+        }
+
+        console_print("Reader stacks: at least %u of %u words never used\n",
+                      (unsigned) minUnused, (unsigned) READER_STACK_SIZE);
+    }
 }
 /*-----------------------------------------------------------*/
 
 void main_readers_writer( void )
 {
-    #define DO_NOTHING
-    #ifndef DO_NOTHING
     /* Initialize */
-    int readerNr[4];
-    
-    newsSpace = xSemaphoreCreateMutex();
-    mutex     = xSemaphoreCreateMutex();
-    
+    UBaseType_t readers = xDemoConfig.uxReaderCount;
+
+    if (xDemoConfig.xBench != eBenchNone)
+    {
+        benchDone = xSemaphoreCreateCounting(BENCH_MAX_TASKS, 0);
+
+        xTaskCreate( prvSupervisorTask,
+                     "Supervisor",
+                     SUPERVISOR_STACK_SIZE,
+                     NULL,
+                     SUPERVISOR_PRIORITY,
+                     NULL );
+
+        /* The scheduler only returns once the supervisor has ended it */
+        vTaskStartScheduler();
+        return;
+    }
+
+    createNewsLock(xDemoConfig.xNewsLock, xDemoConfig.xRwPolicy, readers);
+    console_print("Readers-writer lock policy: %s\n", newsLockName());
+
     /* Start the reader tasks as described in the comments at the top of this
      * file. */
-    for (int i = 0; i <= 3; i++){
-        char buffer[MAX_STRING_SIZE];
-        memset(buffer, '\0', MAX_STRING_SIZE);
-        sprintf(buffer, "%s%d", "Reader", i);
+    for (UBaseType_t i = 0; i < readers; i++){
+        /* The kernel copies the name into the TCB */
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "Reader%u", (unsigned) i);
 
-        readerNr[i] = i;
-        xTaskCreate(prvReader           ,                    /* The function that implements the task. */
-                    buffer, /* The text name assigned to the task - for debug only as it is not used by the kernel. */
-                    READER_STACK_SIZE,                          /* The size of the stack to allocate to the task. */
-                    (void *) &readerNr[i],                                       /* The parameter passed to the task - not used in this simple case. */
-                    READER_PRIORITY,                            /* The priority assigned to the task. */
-                    NULL );                                     /* The task handle is not required, so NULL is passed. */
+        readerTasks[i] = xTaskCreateStatic(prvReader,              /* The function that implements the task. */
+                                           name,                   /* The text name assigned to the task - for debug only as it is not used by the kernel. */
+                                           READER_STACK_SIZE,      /* The size of the stack, in words, of readerStacks[i]. */
+                                           (void *) (uintptr_t) i, /* The number of the reader. */
+                                           READER_PRIORITY,        /* The priority assigned to the task. */
+                                           readerStacks[i],        /* The stack and the TCB of the task, from the pool. */
+                                           &readerTcbs[i]);
     }
 
+    reportReaderMemory(readers);
+
     xTaskCreate( prvWriter           ,             /* The function that implements the task. */
                  "Writer",                         /* The text name assigned to the task - for debug only as it is not used by the kernel. */
                  WRITER_STACK_SIZE,                /* The size of the stack to allocate to the task. */
@@ -143,35 +685,24 @@ void main_readers_writer( void )
     for( ; ; )
     {
     }
-    #endif
 }
 
 /*-----------------------------------------------------------*/
 
 static void prvReader(void * pvParameters )
 {
-    /* Prevent the compiler warning about the unused parameter. */
-    int delayMultiplier = *((int*) pvParameters);
-    int readers = 0;
+    /* Readers are spread over time according to their number */
+    UBaseType_t delayMultiplier = (UBaseType_t) (uintptr_t) pvParameters;
+    char copy[ MAX_STRING_SIZE ];
 
     for( ; ; )
     {
-        /* Try to get to read the news or just go to sleep */
-        if (xSemaphoreTake(mutex, ( TickType_t ) 0)){
-            readers++;
-            /* IF the first reader, wait indefinitely until the writer is through */
-            if (1 == readers) xSemaphoreTake(newsSpace, portMAX_DELAY);
-            xSemaphoreGive(mutex);
-
-            printf("The %s is reading the paper\n", pcTaskGetName(xTaskGetCurrentTaskHandle()));
-
-            /* We are done reading, let's return*/
-            if (xSemaphoreTake(mutex, portMAX_DELAY)){
-                readers--;
-                /* We are the last reader, let's return the newsSpace */
-                if (0 == readers) xSemaphoreGive(newsSpace);
-                xSemaphoreGive(mutex);
-            }
+        /* Wait until no writer is in the way - the lock counts the readers */
+        if (readLockNews(delayMultiplier, portMAX_DELAY)){
+            memcpy(copy, currentNewspaper()->text, sizeof(copy));
+            readUnlockNews(delayMultiplier);
+
+            console_print("The %s is reading the paper: %s\n", pcTaskGetName(xTaskGetCurrentTaskHandle()), copy);
         }
 
         vTaskDelay(delayMultiplier * 50 * A_100_MS_DELAY+ READER_FREQUENCY_MS);
@@ -187,12 +718,33 @@ static void prvWriter(void * pvParameters )
     ( void ) pvParameters;
     
     /* Local variables*/
+    uint32_t attempts = 0;
+
+    vStarvationMonitorInit(&writerStarvation, "Writer",
+                           (xDemoConfig.ulStarvationMs > 0) ? xDemoConfig.ulStarvationMs : WRITER_STARVATION_MS);
 
     for( ; ; )
     {
-        if (xSemaphoreTake(newsSpace, ( TickType_t ) 0)){
+        unsigned long start = ulGetRunTimeCounterValue();
+        BaseType_t updated = writeLockNews(( TickType_t ) 0);
+
+        if (updated){
             changeContentOfNewspaper();
-            xSemaphoreGive(newsSpace);
+            writeUnlockNews();
+        }
+
+        /* Gives up at once when readers hold the newspaper - the update is
+         * pending until an attempt succeeds */
+        vStarvationMonitorRecord(&writerStarvation, start, updated);
+
+        if ((++attempts % WRITER_REPORT_ATTEMPTS) == 0)
+        {
+            vStarvationMonitorReport(&writerStarvation);
+        }
+
+        if ((attempts % READER_REPORT_ATTEMPTS) == 0)
+        {
+            reportReaderMemory(xDemoConfig.uxReaderCount);
         }
 
         vTaskDelay(WRITER_FREQUENCY_MS);
@@ -200,3 +752,1075 @@ static void prvWriter(void * pvParameters )
 }
 /*-----------------------------------------------------------*/
 
+/* Ends a benchmark run of the given number of tasks */
+static void stopBenchTasks( UBaseType_t tasks )
+{
+    /* Wake the tasks up so that they notice the end of the run */
+    benchRunning = pdFALSE;
+
+    for (UBaseType_t x = 0; x < tasks; x++)
+    {
+        xTaskAbortDelay(benchTasks[ x ]);
+    }
+
+    for (UBaseType_t x = 0; x < tasks; x++)
+    {
+        xSemaphoreTake(benchDone, portMAX_DELAY);
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* One run of the benchmark, newsSpace is created for it */
+static BenchResult_t * runBench( NewsLock_t lock, RwLockPolicy_t policy, uint32_t readPercent,
+                                 BenchResult_t * result )
+{
+    char taskName[ configMAX_TASK_NAME_LEN ];
+    UBaseType_t tasks = xDemoConfig.uxTaskCount;
+
+    memset(&benchStats, 0, sizeof(benchStats));
+    vHistogramReset(&benchStats.readWait);
+    vHistogramReset(&benchStats.writeWait);
+    createNewsLock(lock, policy, tasks);
+    vStarvationMonitorInit(&writerStarvation, "Writers",
+                           (xDemoConfig.ulStarvationMs > 0) ? xDemoConfig.ulStarvationMs : BENCH_STARVATION_MS);
+    benchReadPercent = readPercent;
+    benchRunning = pdTRUE;
+
+    for (UBaseType_t x = 0; x < tasks; x++)
+    {
+        snprintf(taskName, sizeof(taskName), "Bench%u", (unsigned) x);
+        xTaskCreate(prvBenchTask, taskName, BENCH_STACK_SIZE, (void *) (uintptr_t) x, READER_PRIORITY, &benchTasks[ x ]);
+    }
+
+    unsigned long start = ulGetRunTimeCounterValue();
+
+    vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+
+    double seconds = (double) (ulGetRunTimeCounterValue() - start) / (double) runtimeCOUNTS_PER_SECOND;
+
+    stopBenchTasks(tasks);
+
+    result->lock = newsLockName();
+    result->readPercent = readPercent;
+    result->readsPerSecond = (double) benchStats.reads / seconds;
+    result->writesPerSecond = (double) benchStats.writes / seconds;
+    result->readWaitP50 = ullHistogramPercentile(&benchStats.readWait, 50.0);
+    result->readWaitP99 = ullHistogramPercentile(&benchStats.readWait, 99.0);
+    result->writeWaitP50 = ullHistogramPercentile(&benchStats.writeWait, 50.0);
+    result->writeWaitP99 = ullHistogramPercentile(&benchStats.writeWait, 99.0);
+    result->writeWaitMax = (benchStats.writeWait.ullCount > 0) ? benchStats.writeWait.ullMax : 0;
+    result->writeSkips = writerStarvation.ulSkipped;
+    result->ageP99 = ullHistogramPercentile(&writerStarvation.xAge, 99.0);
+    result->alarms = writerStarvation.ulAlarms;
+
+    deleteNewsLock();
+
+    /* Give the idle task a chance to free the deleted tasks */
+    vTaskDelay(A_100_MS_DELAY);
+
+    return result;
+}
+/*-----------------------------------------------------------*/
+
+static void runRatioBenchmark( void )
+{
+    static const uint32_t readPercents[ BENCH_RATIO_COUNT ] = BENCH_READ_PERCENTS;
+    RwLockPolicy_t first = xDemoConfig.xRwPolicy;
+    RwLockPolicy_t last = xDemoConfig.xRwPolicy;
+    UBaseType_t resultCount = 0;
+
+    if (xDemoConfig.xAllRwPolicies == pdTRUE)
+    {
+        first = eRwLockReaderPreference;
+        last = eRwLockPolicyCount - 1;
+    }
+
+    /* A single run per ratio for the big-reader lock and RCU */
+    if (xDemoConfig.xNewsLock != eNewsRwLock)
+    {
+        last = first;
+    }
+
+    console_print("\nReaders-writer lock benchmark: %u task(s), %lu s per run, critical section %lu us\n",
+                  (unsigned) xDemoConfig.uxTaskCount,
+                  (unsigned long) xDemoConfig.ulRunSeconds,
+                  (unsigned long) xDemoConfig.ulCriticalSectionLength);
+
+    for (RwLockPolicy_t policy = first; policy <= last; policy++)
+    {
+        for (int x = 0; x < BENCH_RATIO_COUNT; x++)
+        {
+            BenchResult_t * result = runBench(xDemoConfig.xNewsLock, policy, readPercents[ x ],
+                                              &benchResults[ resultCount++ ]);
+
+            console_print("%-12s %3lu%% reads: %12.0f reads/s %10.0f writes/s\n",
+                          result->lock, (unsigned long) result->readPercent,
+                          result->readsPerSecond, result->writesPerSecond);
+        }
+    }
+
+    console_print("\nReaders-writer lock throughput - wait times in run time counter units (" runtimeUNIT_NAME ")\n");
+    console_print("%-12s %6s %12s %12s %10s %10s %10s %10s %12s %8s %12s %6s\n",
+                  "Policy", "Reads", "Reads/s", "Writes/s", "R wait p50", "p99",
+                  "W wait p50", "p99", "max", "W skips", "W age p99", "Alarms");
+
+    for (UBaseType_t x = 0; x < resultCount; x++)
+    {
+        const BenchResult_t * result = &benchResults[ x ];
+
+        console_print("%-12s %5lu%% %12.0f %12.0f %10llu %10llu %10llu %10llu %12llu %8lu %12llu %6lu\n",
+                      result->lock,
+                      (unsigned long) result->readPercent,
+                      result->readsPerSecond,
+                      result->writesPerSecond,
+                      (unsigned long long) result->readWaitP50,
+                      (unsigned long long) result->readWaitP99,
+                      (unsigned long long) result->writeWaitP50,
+                      (unsigned long long) result->writeWaitP99,
+                      (unsigned long long) result->writeWaitMax,
+                      (unsigned long) result->writeSkips,
+                      (unsigned long long) result->ageP99,
+                      (unsigned long) result->alarms);
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* One run of the big-reader benchmark: readers read back to back, the
+ * writer writes every SCALING_WRITE_PERIOD */
+static ScalingResult_t * runScaling( NewsLock_t lock, UBaseType_t readers, ScalingResult_t * result )
+{
+    char taskName[ configMAX_TASK_NAME_LEN ];
+    uint64_t reads = 0;
+
+    memset(scalingReads, 0, sizeof(scalingReads));
+    scalingWrites = 0;
+    vHistogramReset(&scalingWriteWait);
+    createNewsLock(lock, xDemoConfig.xRwPolicy, readers);
+    benchRunning = pdTRUE;
+
+    for (UBaseType_t x = 0; x < readers; x++)
+    {
+        snprintf(taskName, sizeof(taskName), "Reader%u", (unsigned) x);
+        xTaskCreate(prvScalingReaderTask, taskName, BENCH_STACK_SIZE, (void *) (uintptr_t) x, READER_PRIORITY, &benchTasks[ x ]);
+    }
+
+    xTaskCreate(prvScalingWriterTask, "Writer", BENCH_STACK_SIZE, NULL, WRITER_PRIORITY, &benchTasks[ readers ]);
+
+    unsigned long start = ulGetRunTimeCounterValue();
+
+    vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+
+    double seconds = (double) (ulGetRunTimeCounterValue() - start) / (double) runtimeCOUNTS_PER_SECOND;
+
+    stopBenchTasks(readers + 1);
+
+    for (UBaseType_t x = 0; x < readers; x++)
+    {
+        reads += scalingReads[ x ];
+    }
+
+    result->lock = newsLockName();
+    result->readers = readers;
+    result->readsPerSecond = (double) reads / seconds;
+    result->writes = scalingWrites;
+    result->writeWaitP50 = ullHistogramPercentile(&scalingWriteWait, 50.0);
+    result->writeWaitP99 = ullHistogramPercentile(&scalingWriteWait, 99.0);
+    result->writeWaitMax = (scalingWriteWait.ullCount > 0) ? scalingWriteWait.ullMax : 0;
+
+    deleteNewsLock();
+
+    /* Give the idle task a chance to free the deleted tasks */
+    vTaskDelay(A_100_MS_DELAY);
+
+    return result;
+}
+/*-----------------------------------------------------------*/
+
+static void runScalingBenchmark( void )
+{
+    UBaseType_t resultCount = 0;
+
+    console_print("\nBig-reader lock benchmark: %u .. %u readers, one writer every %lu ms, %lu s per run, "
+                  "critical section %lu us\n",
+                  (unsigned) SCALING_MIN_READERS, (unsigned) SCALING_MAX_READERS,
+                  (unsigned long) (SCALING_WRITE_PERIOD * portTICK_PERIOD_MS),
+                  (unsigned long) xDemoConfig.ulRunSeconds,
+                  (unsigned long) xDemoConfig.ulCriticalSectionLength);
+
+    for (NewsLock_t lock = eNewsRwLock; lock <= eNewsRcu; lock++)
+    {
+        for (UBaseType_t readers = SCALING_MIN_READERS; readers <= SCALING_MAX_READERS; readers *= 2)
+        {
+            ScalingResult_t * result = runScaling(lock, readers, &scalingResults[ resultCount++ ]);
+
+            console_print("%-12s %4u readers: %12.0f reads/s\n",
+                          result->lock, (unsigned) readers, result->readsPerSecond);
+        }
+    }
+
+    console_print("\nRead throughput by number of readers - wait times in run time counter units (" runtimeUNIT_NAME ")\n");
+    console_print("%-12s %7s %12s %12s %8s %10s %10s %12s\n",
+                  "Lock", "Readers", "Reads/s", "Per reader", "Writes", "W wait p50", "p99", "max");
+
+    for (UBaseType_t x = 0; x < resultCount; x++)
+    {
+        const ScalingResult_t * result = &scalingResults[ x ];
+
+        console_print("%-12s %7u %12.0f %12.0f %8lu %10llu %10llu %12llu\n",
+                      result->lock,
+                      (unsigned) result->readers,
+                      result->readsPerSecond,
+                      result->readsPerSecond / (double) result->readers,
+                      (unsigned long) result->writes,
+                      (unsigned long long) result->writeWaitP50,
+                      (unsigned long long) result->writeWaitP99,
+                      (unsigned long long) result->writeWaitMax);
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* One run of the upgrade benchmark: --tasks readers read back to back, the
+ * deciders take the write lock or an upgradable read lock to decide */
+static UpgradeResult_t * runUpgrade( RwLockPolicy_t policy, BaseType_t upgradable, UpgradeResult_t * result )
+{
+    char taskName[ configMAX_TASK_NAME_LEN ];
+    UBaseType_t readers = xDemoConfig.uxTaskCount;
+    uint64_t reads = 0;
+
+    memset(scalingReads, 0, sizeof(scalingReads));
+    memset(&upgradeStats, 0, sizeof(upgradeStats));
+    vHistogramReset(&upgradeStats.exclusiveHold);
+    createNewsLock(eNewsRwLock, policy, readers);
+    upgradeDecide = upgradable;
+    benchRunning = pdTRUE;
+
+    for (UBaseType_t x = 0; x < readers; x++)
+    {
+        snprintf(taskName, sizeof(taskName), "Reader%u", (unsigned) x);
+        xTaskCreate(prvScalingReaderTask, taskName, BENCH_STACK_SIZE, (void *) (uintptr_t) x, READER_PRIORITY, &benchTasks[ x ]);
+    }
+
+    for (UBaseType_t x = 0; x < UPGRADE_DECIDERS; x++)
+    {
+        snprintf(taskName, sizeof(taskName), "Decider%u", (unsigned) x);
+        xTaskCreate(prvDeciderTask, taskName, BENCH_STACK_SIZE, (void *) (uintptr_t) x, WRITER_PRIORITY, &benchTasks[ readers + x ]);
+    }
+
+    unsigned long start = ulGetRunTimeCounterValue();
+
+    vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+
+    unsigned long elapsed = ulGetRunTimeCounterValue() - start;
+    double seconds = (double) elapsed / (double) runtimeCOUNTS_PER_SECOND;
+
+    stopBenchTasks(readers + UPGRADE_DECIDERS);
+
+    for (UBaseType_t x = 0; x < readers; x++)
+    {
+        reads += scalingReads[ x ];
+    }
+
+    result->lock = newsLockName();
+    result->upgradable = upgradable;
+    result->decisionsPerSecond = (double) upgradeStats.decisions / seconds;
+    result->readsPerSecond = (double) reads / seconds;
+    result->changes = upgradeStats.changes;
+    result->skips = upgradeStats.skips;
+    result->holdP50 = ullHistogramPercentile(&upgradeStats.exclusiveHold, 50.0);
+    result->holdP99 = ullHistogramPercentile(&upgradeStats.exclusiveHold, 99.0);
+    result->holdMax = (upgradeStats.exclusiveHold.ullCount > 0) ? upgradeStats.exclusiveHold.ullMax : 0;
+    result->exclusivePercent = 100.0 * (double) upgradeStats.exclusiveTotal / (double) elapsed;
+
+    deleteNewsLock();
+
+    /* Give the idle task a chance to free the deleted tasks */
+    vTaskDelay(A_100_MS_DELAY);
+
+    return result;
+}
+/*-----------------------------------------------------------*/
+
+static void runUpgradeBenchmark( void )
+{
+    RwLockPolicy_t first = xDemoConfig.xRwPolicy;
+    RwLockPolicy_t last = xDemoConfig.xRwPolicy;
+    UBaseType_t resultCount = 0;
+
+    if (xDemoConfig.xAllRwPolicies == pdTRUE)
+    {
+        first = eRwLockReaderPreference;
+        last = eRwLockPolicyCount - 1;
+    }
+
+    console_print("\nUpgradable read lock benchmark: %u reader(s), %u deciders every %lu ms changing %u%% of the time, "
+                  "%lu s per run, critical section %lu us\n",
+                  (unsigned) xDemoConfig.uxTaskCount, (unsigned) UPGRADE_DECIDERS,
+                  (unsigned long) (UPGRADE_DECIDE_PERIOD * portTICK_PERIOD_MS), (unsigned) UPGRADE_CHANGE_PERCENT,
+                  (unsigned long) xDemoConfig.ulRunSeconds,
+                  (unsigned long) xDemoConfig.ulCriticalSectionLength);
+
+    for (RwLockPolicy_t policy = first; policy <= last; policy++)
+    {
+        for (BaseType_t upgradable = pdFALSE; upgradable <= pdTRUE; upgradable++)
+        {
+            UpgradeResult_t * result = runUpgrade(policy, upgradable, &upgradeResults[ resultCount++ ]);
+
+            console_print("%-12s %-10s %12.0f decisions/s %12.0f reads/s\n",
+                          result->lock, result->upgradable ? "upgradable" : "write",
+                          result->decisionsPerSecond, result->readsPerSecond);
+        }
+    }
+
+    console_print("\nExclusive hold time of the deciders - times in run time counter units (" runtimeUNIT_NAME ")\n");
+    console_print("%-12s %-10s %12s %12s %8s %6s %10s %10s %12s %10s\n",
+                  "Policy", "Decide in", "Decisions/s", "Reads/s", "Changes", "Skips",
+                  "Hold p50", "p99", "max", "Exclusive");
+
+    for (UBaseType_t x = 0; x < resultCount; x++)
+    {
+        const UpgradeResult_t * result = &upgradeResults[ x ];
+
+        console_print("%-12s %-10s %12.0f %12.0f %8lu %6lu %10llu %10llu %12llu %9.2f%%\n",
+                      result->lock,
+                      result->upgradable ? "upgradable" : "write",
+                      result->decisionsPerSecond,
+                      result->readsPerSecond,
+                      (unsigned long) result->changes,
+                      (unsigned long) result->skips,
+                      (unsigned long long) result->holdP50,
+                      (unsigned long long) result->holdP99,
+                      (unsigned long long) result->holdMax,
+                      result->exclusivePercent);
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* The write batcher callbacks - csUnits of work per change, as with the
+ * write lock taken for each change */
+static BaseType_t batchLockNews( void * context )
+{
+    ( void ) context;
+    return writeLockNews(BENCH_LOCK_TIMEOUT);
+}
+
+static void batchUnlockNews( void * context )
+{
+    ( void ) context;
+    writeUnlockNews();
+}
+
+static void batchApplyChange( void * context, const void * change )
+{
+    ( void ) change;
+    updateNewspaper(*((const uint64_t *) context));
+}
+/*-----------------------------------------------------------*/
+
+/* One run of the coalescing benchmark: --tasks readers read back to back
+ * while the producers change the newspaper, directly or through newsBatcher */
+static CoalesceResult_t * runCoalesce( NewsLock_t lock, RwLockPolicy_t policy, BaseType_t batched,
+                                       CoalesceResult_t * result )
+{
+    static uint64_t csUnits;
+    char taskName[ configMAX_TASK_NAME_LEN ];
+    UBaseType_t readers = xDemoConfig.uxTaskCount;
+
+    csUnits = ullWorkUnitsForUs(xDemoConfig.ulCriticalSectionLength);
+    memset(&benchStats, 0, sizeof(benchStats));
+    vHistogramReset(&benchStats.readWait);
+    vHistogramReset(&benchStats.writeWait);
+    coalesceDirectChanges = 0;
+    coalesceDirectSkips = 0;
+    coalesceBatched = batched;
+    createNewsLock(lock, policy, readers);
+
+    if (batched)
+    {
+        vWriteBatcherInit(&newsBatcher, COALESCE_QUEUE_LENGTH, sizeof(NewsChange_t),
+                          batchLockNews, batchUnlockNews, batchApplyChange, &csUnits);
+        vWriteBatcherStart(&newsBatcher, BATCHER_PRIORITY, BENCH_STACK_SIZE);
+    }
+
+    /* Readers only */
+    benchReadPercent = 100;
+    benchRunning = pdTRUE;
+
+    for (UBaseType_t x = 0; x < readers; x++)
+    {
+        snprintf(taskName, sizeof(taskName), "Reader%u", (unsigned) x);
+        xTaskCreate(prvBenchTask, taskName, BENCH_STACK_SIZE, (void *) (uintptr_t) x, READER_PRIORITY, &benchTasks[ x ]);
+    }
+
+    for (UBaseType_t x = 0; x < COALESCE_PRODUCERS; x++)
+    {
+        snprintf(taskName, sizeof(taskName), "Producer%u", (unsigned) x);
+        xTaskCreate(prvProducerTask, taskName, BENCH_STACK_SIZE, (void *) (uintptr_t) x, WRITER_PRIORITY, &benchTasks[ readers + x ]);
+    }
+
+    unsigned long start = ulGetRunTimeCounterValue();
+
+    vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+
+    double seconds = (double) (ulGetRunTimeCounterValue() - start) / (double) runtimeCOUNTS_PER_SECOND;
+
+    stopBenchTasks(readers + COALESCE_PRODUCERS);
+
+    result->lock = newsLockName();
+    result->batched = batched;
+
+    if (batched)
+    {
+        vWriteBatcherStop(&newsBatcher);
+        vWriteBatcherReport(&newsBatcher, result->lock);
+
+        result->changesPerSecond = (double) newsBatcher.ulApplied / seconds;
+        result->acquisitions = newsBatcher.ulBatches;
+        result->mergedMax = (newsBatcher.xBatchSize.ullCount > 0) ? newsBatcher.xBatchSize.ullMax : 0;
+        result->dropped = newsBatcher.ulDropped;
+        vWriteBatcherDelete(&newsBatcher);
+    }
+    else
+    {
+        result->changesPerSecond = (double) coalesceDirectChanges / seconds;
+        result->acquisitions = coalesceDirectChanges;
+        result->mergedMax = (coalesceDirectChanges > 0) ? 1 : 0;
+        result->dropped = coalesceDirectSkips;
+    }
+
+    result->mergedPerAcquisition = (result->acquisitions > 0) ?
+                                   result->changesPerSecond * seconds / (double) result->acquisitions : 0.0;
+    result->readsPerSecond = (double) benchStats.reads / seconds;
+    result->readWaitP50 = ullHistogramPercentile(&benchStats.readWait, 50.0);
+    result->readWaitP99 = ullHistogramPercentile(&benchStats.readWait, 99.0);
+    result->readBlockedUs = runtimeCOUNTS_TO_US(benchStats.readWait.ullSum);
+
+    deleteNewsLock();
+
+    /* Give the idle task a chance to free the deleted tasks */
+    vTaskDelay(A_100_MS_DELAY);
+
+    return result;
+}
+/*-----------------------------------------------------------*/
+
+static void runCoalesceBenchmark( void )
+{
+    RwLockPolicy_t first = xDemoConfig.xRwPolicy;
+    RwLockPolicy_t last = xDemoConfig.xRwPolicy;
+    UBaseType_t resultCount = 0;
+
+    if (xDemoConfig.xAllRwPolicies == pdTRUE)
+    {
+        first = eRwLockReaderPreference;
+        last = eRwLockPolicyCount - 1;
+    }
+
+    /* A single run per mode for the big-reader lock and RCU */
+    if (xDemoConfig.xNewsLock != eNewsRwLock)
+    {
+        last = first;
+    }
+
+    console_print("\nWrite coalescing benchmark: %u reader(s), %u producers changing every %lu ms, "
+                  "%lu s per run, critical section %lu us\n",
+                  (unsigned) xDemoConfig.uxTaskCount, (unsigned) COALESCE_PRODUCERS,
+                  (unsigned long) (COALESCE_PERIOD * portTICK_PERIOD_MS),
+                  (unsigned long) xDemoConfig.ulRunSeconds,
+                  (unsigned long) xDemoConfig.ulCriticalSectionLength);
+
+    for (RwLockPolicy_t policy = first; policy <= last; policy++)
+    {
+        for (BaseType_t batched = pdFALSE; batched <= pdTRUE; batched++)
+        {
+            CoalesceResult_t * result = runCoalesce(xDemoConfig.xNewsLock, policy, batched,
+                                                    &coalesceResults[ resultCount++ ]);
+
+            console_print("%-12s %-7s %12.0f changes/s %12.0f reads/s\n",
+                          result->lock, result->batched ? "batched" : "direct",
+                          result->changesPerSecond, result->readsPerSecond);
+        }
+    }
+
+    console_print("\nReader blocking by write mode - wait times in run time counter units (" runtimeUNIT_NAME ")\n");
+    console_print("%-12s %-7s %10s %10s %8s %6s %8s %12s %10s %10s %12s\n",
+                  "Policy", "Writes", "Changes/s", "Locks", "Merged", "max", "Dropped",
+                  "Reads/s", "R wait p50", "p99", "Blocked us");
+
+    for (UBaseType_t x = 0; x < resultCount; x++)
+    {
+        const CoalesceResult_t * result = &coalesceResults[ x ];
+
+        console_print("%-12s %-7s %10.0f %10lu %8.2f %6llu %8lu %12.0f %10llu %10llu %12llu\n",
+                      result->lock,
+                      result->batched ? "batched" : "direct",
+                      result->changesPerSecond,
+                      (unsigned long) result->acquisitions,
+                      result->mergedPerAcquisition,
+                      (unsigned long long) result->mergedMax,
+                      (unsigned long) result->dropped,
+                      result->readsPerSecond,
+                      (unsigned long long) result->readWaitP50,
+                      (unsigned long long) result->readWaitP99,
+                      (unsigned long long) result->readBlockedUs);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void resetWorkloadStats( WorkloadStats_t * stats )
+{
+    memset(stats, 0, sizeof(*stats));
+    vHistogramReset(&stats->readLatency);
+    vHistogramReset(&stats->writeLatency);
+}
+/*-----------------------------------------------------------*/
+
+/* Takes over the statistics of the last second, prints them and appends them
+ * to the CSV file */
+static void sampleWorkload( FILE * csv, UBaseType_t run, uint32_t second )
+{
+    taskENTER_CRITICAL();
+    workloadSample = workloadStats;
+    resetWorkloadStats(&workloadStats);
+    taskEXIT_CRITICAL();
+
+    workloadTotal.reads += workloadSample.reads;
+    workloadTotal.writes += workloadSample.writes;
+    workloadTotal.missed += workloadSample.missed;
+    workloadTotal.timeouts += workloadSample.timeouts;
+    vHistogramMerge(&workloadTotal.readLatency, &workloadSample.readLatency);
+    vHistogramMerge(&workloadTotal.writeLatency, &workloadSample.writeLatency);
+
+    uint64_t readP50 = ullHistogramPercentile(&workloadSample.readLatency, 50.0);
+    uint64_t readP99 = ullHistogramPercentile(&workloadSample.readLatency, 99.0);
+    uint64_t readMax = (workloadSample.readLatency.ullCount > 0) ? workloadSample.readLatency.ullMax : 0;
+    uint64_t writeP50 = ullHistogramPercentile(&workloadSample.writeLatency, 50.0);
+    uint64_t writeP99 = ullHistogramPercentile(&workloadSample.writeLatency, 99.0);
+    uint64_t writeMax = (workloadSample.writeLatency.ullCount > 0) ? workloadSample.writeLatency.ullMax : 0;
+
+    console_print("%-12s %4lu s %10lu reads %8lu writes %6lu missed  read p99 %10llu " runtimeUNIT_NAME "  write p99 %10llu " runtimeUNIT_NAME "\n",
+                  newsLockName(), (unsigned long) second,
+                  (unsigned long) workloadSample.reads, (unsigned long) workloadSample.writes,
+                  (unsigned long) workloadSample.missed,
+                  (unsigned long long) readP99, (unsigned long long) writeP99);
+
+    if (csv != NULL)
+    {
+        fprintf(csv, "%u,%s,%u,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                (unsigned) run, newsLockName(),
+                (unsigned) xDemoConfig.uxReaderCount, (unsigned) xDemoConfig.uxWriterCount,
+                (unsigned long) xDemoConfig.ulReadPercent, (unsigned long) xDemoConfig.ulCriticalSectionLength,
+                (unsigned long) xDemoConfig.ulOpRate, (unsigned long) second,
+                (unsigned long) workloadSample.reads, (unsigned long) workloadSample.writes,
+                (unsigned long) workloadSample.missed, (unsigned long) workloadSample.timeouts,
+                (unsigned long long) readP50, (unsigned long long) readP99, (unsigned long long) readMax,
+                (unsigned long long) writeP50, (unsigned long long) writeP99, (unsigned long long) writeMax);
+        fflush(csv);
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* One run of the workload generator with the given lock */
+static WorkloadResult_t * runWorkload( NewsLock_t lock, RwLockPolicy_t policy, FILE * csv, UBaseType_t run,
+                                       WorkloadResult_t * result )
+{
+    char taskName[ configMAX_TASK_NAME_LEN ];
+    UBaseType_t readers = xDemoConfig.uxReaderCount;
+    UBaseType_t tasks = readers + xDemoConfig.uxWriterCount;
+    TickType_t wakeTime;
+
+    resetWorkloadStats(&workloadStats);
+    resetWorkloadStats(&workloadTotal);
+    createNewsLock(lock, policy, readers);
+    benchRunning = pdTRUE;
+    workloadStart = ulGetRunTimeCounterValue();
+
+    /* The readers come first, their index is their slot in the lock */
+    for (UBaseType_t x = 0; x < tasks; x++)
+    {
+        snprintf(taskName, sizeof(taskName), (x < readers) ? "Reader%u" : "Writer%u",
+                 (unsigned) ((x < readers) ? x : x - readers));
+        xTaskCreate(prvWorkloadTask, taskName, BENCH_STACK_SIZE, (void *) (uintptr_t) x, READER_PRIORITY, &benchTasks[ x ]);
+    }
+
+    wakeTime = xTaskGetTickCount();
+
+    for (uint32_t second = 1; second <= xDemoConfig.ulRunSeconds; second++)
+    {
+        xTaskDelayUntil(&wakeTime, WORKLOAD_SAMPLE_PERIOD);
+        sampleWorkload(csv, run, second);
+    }
+
+    double seconds = (double) (ulGetRunTimeCounterValue() - workloadStart) / (double) runtimeCOUNTS_PER_SECOND;
+
+    stopBenchTasks(tasks);
+
+    result->lock = newsLockName();
+    result->readsPerSecond = (double) workloadTotal.reads / seconds;
+    result->writesPerSecond = (double) workloadTotal.writes / seconds;
+    result->missed = workloadTotal.missed;
+    result->timeouts = workloadTotal.timeouts;
+    result->readP50 = ullHistogramPercentile(&workloadTotal.readLatency, 50.0);
+    result->readP99 = ullHistogramPercentile(&workloadTotal.readLatency, 99.0);
+    result->writeP50 = ullHistogramPercentile(&workloadTotal.writeLatency, 50.0);
+    result->writeP99 = ullHistogramPercentile(&workloadTotal.writeLatency, 99.0);
+
+    deleteNewsLock();
+
+    /* Give the idle task a chance to free the deleted tasks */
+    vTaskDelay(A_100_MS_DELAY);
+
+    return result;
+}
+/*-----------------------------------------------------------*/
+
+static void runWorkloadBenchmark( void )
+{
+    UBaseType_t resultCount = 0;
+    FILE * csv = NULL;
+
+    if (xDemoConfig.pcCsvPath != NULL)
+    {
+        csv = fopen(xDemoConfig.pcCsvPath, "w");
+
+        if (csv == NULL)
+        {
+            console_print("Cannot write %s: %s\n", xDemoConfig.pcCsvPath, strerror(errno));
+        }
+        else
+        {
+            fprintf(csv, "run,lock,readers,writers,read_percent,cs_us,op_rate,second,reads,writes,missed,timeouts,"
+                    "read_p50_" runtimeUNIT_NAME ",read_p99_" runtimeUNIT_NAME ",read_max_" runtimeUNIT_NAME ","
+                    "write_p50_" runtimeUNIT_NAME ",write_p99_" runtimeUNIT_NAME ",write_max_" runtimeUNIT_NAME "\n");
+        }
+    }
+
+    console_print("\nWorkload: %u reader(s), %u writer(s), %lu operations/s, %lu%% reads, critical section %lu us, "
+                  "%lu s per run\n",
+                  (unsigned) xDemoConfig.uxReaderCount, (unsigned) xDemoConfig.uxWriterCount,
+                  (unsigned long) xDemoConfig.ulOpRate, (unsigned long) xDemoConfig.ulReadPercent,
+                  (unsigned long) xDemoConfig.ulCriticalSectionLength, (unsigned long) xDemoConfig.ulRunSeconds);
+
+    /* Every lock of the newspaper with --rw-policy all */
+    if (xDemoConfig.xAllRwPolicies == pdTRUE)
+    {
+        for (RwLockPolicy_t policy = eRwLockReaderPreference; policy < eRwLockPolicyCount; policy++)
+        {
+            runWorkload(eNewsRwLock, policy, csv, resultCount, &workloadResults[ resultCount ]);
+            resultCount++;
+        }
+
+        for (NewsLock_t lock = eNewsBigReader; lock <= eNewsRcu; lock++)
+        {
+            runWorkload(lock, xDemoConfig.xRwPolicy, csv, resultCount, &workloadResults[ resultCount ]);
+            resultCount++;
+        }
+    }
+    else
+    {
+        runWorkload(xDemoConfig.xNewsLock, xDemoConfig.xRwPolicy, csv, resultCount, &workloadResults[ resultCount ]);
+        resultCount++;
+    }
+
+    if (csv != NULL)
+    {
+        fclose(csv);
+        console_print("Per-second results written to %s\n", xDemoConfig.pcCsvPath);
+    }
+
+    console_print("\nWorkload throughput - latencies in run time counter units (" runtimeUNIT_NAME ")\n");
+    console_print("%-12s %12s %12s %8s %8s %10s %10s %10s %10s\n",
+                  "Lock", "Reads/s", "Writes/s", "Missed", "Timeouts", "Read p50", "p99", "Write p50", "p99");
+
+    for (UBaseType_t x = 0; x < resultCount; x++)
+    {
+        const WorkloadResult_t * result = &workloadResults[ x ];
+
+        console_print("%-12s %12.0f %12.0f %8lu %8lu %10llu %10llu %10llu %10llu\n",
+                      result->lock,
+                      result->readsPerSecond,
+                      result->writesPerSecond,
+                      (unsigned long) result->missed,
+                      (unsigned long) result->timeouts,
+                      (unsigned long long) result->readP50,
+                      (unsigned long long) result->readP99,
+                      (unsigned long long) result->writeP50,
+                      (unsigned long long) result->writeP99);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSupervisorTask( void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    if (xDemoConfig.xBench == eBenchBigReader)
+    {
+        runScalingBenchmark();
+    }
+    else if (xDemoConfig.xBench == eBenchUpgrade)
+    {
+        runUpgradeBenchmark();
+    }
+    else if (xDemoConfig.xBench == eBenchCoalesce)
+    {
+        runCoalesceBenchmark();
+    }
+    else if (xDemoConfig.xBench == eBenchWorkload)
+    {
+        runWorkloadBenchmark();
+    }
+    else
+    {
+        runRatioBenchmark();
+    }
+
+    /* main_readers_writer() returns once the scheduler is ended */
+    vTaskEndScheduler();
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchTask( void * pvParameters )
+{
+    /* Each task draws its own sequence of reads and writes */
+    UBaseType_t index = (UBaseType_t) (uintptr_t) pvParameters;
+    uint32_t seed = 1U + (uint32_t) index;
+    uint64_t csUnits = ullWorkUnitsForUs(xDemoConfig.ulCriticalSectionLength);
+
+    while (benchRunning == pdTRUE)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        BaseType_t write = ((seed >> 8) % 100U) >= benchReadPercent;
+        unsigned long start = ulGetRunTimeCounterValue();
+
+        /* Times out now and then so that the end of the run is noticed */
+        if (write)
+        {
+            BaseType_t updated = writeLockNews(BENCH_LOCK_TIMEOUT);
+
+            if (updated)
+            {
+                unsigned long wait = ulGetRunTimeCounterValue() - start;
+
+                updateNewspaper(csUnits);
+                writeUnlockNews();
+
+                taskENTER_CRITICAL();
+                benchStats.writes++;
+                vHistogramRecord(&benchStats.writeWait, wait);
+                taskEXIT_CRITICAL();
+            }
+
+            vStarvationMonitorRecord(&writerStarvation, start, updated);
+        }
+        else
+        {
+            if (readLockNews(index, BENCH_LOCK_TIMEOUT))
+            {
+                unsigned long wait = ulGetRunTimeCounterValue() - start;
+
+                const Newspaper_t * paper = currentNewspaper();
+
+                vWorkBurnUnits(csUnits);
+                configASSERT(paper->text[ 0 ] == 'E');
+                readUnlockNews(index);
+
+                taskENTER_CRITICAL();
+                benchStats.reads++;
+                vHistogramRecord(&benchStats.readWait, wait);
+                taskEXIT_CRITICAL();
+            }
+        }
+    }
+
+    xSemaphoreGive(benchDone);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void prvScalingReaderTask( void * pvParameters )
+{
+    /* Index among the readers - also its slot in the big-reader lock */
+    UBaseType_t index = (UBaseType_t) (uintptr_t) pvParameters;
+    uint64_t csUnits = ullWorkUnitsForUs(xDemoConfig.ulCriticalSectionLength);
+    uint32_t reads = 0;
+
+    while (benchRunning == pdTRUE)
+    {
+        if (readLockNews(index, BENCH_LOCK_TIMEOUT))
+        {
+            const Newspaper_t * paper = currentNewspaper();
+
+            vWorkBurnUnits(csUnits);
+            configASSERT(paper->text[ 0 ] == 'E');
+            readUnlockNews(index);
+
+            /* Nothing shared on the read path - not even the statistics */
+            scalingReads[ index ] = ++reads;
+        }
+    }
+
+    xSemaphoreGive(benchDone);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void prvScalingWriterTask( void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    uint64_t csUnits = ullWorkUnitsForUs(xDemoConfig.ulCriticalSectionLength);
+    TickType_t wakeTime = xTaskGetTickCount();
+
+    while (benchRunning == pdTRUE)
+    {
+        xTaskDelayUntil(&wakeTime, SCALING_WRITE_PERIOD);
+
+        unsigned long start = ulGetRunTimeCounterValue();
+
+        if (writeLockNews(BENCH_LOCK_TIMEOUT))
+        {
+            /* Only this task records into the histogram */
+            vHistogramRecord(&scalingWriteWait, ulGetRunTimeCounterValue() - start);
+            updateNewspaper(csUnits);
+            scalingWrites++;
+            writeUnlockNews();
+        }
+    }
+
+    xSemaphoreGive(benchDone);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+/* Frees the editions of the newspaper nobody reads any more, in place of the
+ * idle task */
+static void prvGracePeriodTask( void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    while (gracePeriodRunning == pdTRUE)
+    {
+        vTaskDelay(GRACE_PERIOD);
+        uxRcuReclaim(&newsVersions);
+    }
+
+    xSemaphoreGive(benchDone);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+/* Reads the newspaper to decide whether to change it - with the write lock
+ * held throughout, as prvWriter does, or with an upgradable read lock that is
+ * upgraded for the change only */
+static void prvDeciderTask( void * pvParameters )
+{
+    UBaseType_t index = (UBaseType_t) (uintptr_t) pvParameters;
+    uint32_t seed = 7U + (uint32_t) index;
+    uint64_t csUnits = ullWorkUnitsForUs(xDemoConfig.ulCriticalSectionLength);
+    TickType_t wakeTime = xTaskGetTickCount();
+
+    while (benchRunning == pdTRUE)
+    {
+        xTaskDelayUntil(&wakeTime, UPGRADE_DECIDE_PERIOD);
+
+        seed = seed * 1664525U + 1013904223U;
+        BaseType_t change = ((seed >> 8) % 100U) < UPGRADE_CHANGE_PERCENT;
+        unsigned long holdStart = 0;
+        BaseType_t held = pdFALSE;
+
+        if (upgradeDecide == pdFALSE)
+        {
+            if (writeLockNews(BENCH_LOCK_TIMEOUT))
+            {
+                holdStart = ulGetRunTimeCounterValue();
+                held = pdTRUE;
+
+                /* Decide, then change */
+                vWorkBurnUnits(csUnits);
+                configASSERT(currentNewspaper()->text[ 0 ] == 'E');
+
+                if (change)
+                {
+                    updateNewspaper(csUnits);
+                }
+
+                writeUnlockNews();
+            }
+        }
+        else if (xRwLockUpgradableLock(&newsSpace, BENCH_LOCK_TIMEOUT))
+        {
+            /* Decide next to the readers */
+            vWorkBurnUnits(csUnits);
+            configASSERT(currentNewspaper()->text[ 0 ] == 'E');
+
+            if (!change)
+            {
+                vRwLockUpgradableUnlock(&newsSpace);
+                held = pdTRUE;
+            }
+            else if (xRwLockUpgrade(&newsSpace, BENCH_LOCK_TIMEOUT))
+            {
+                holdStart = ulGetRunTimeCounterValue();
+                held = pdTRUE;
+                updateNewspaper(csUnits);
+                vRwLockWriteUnlock(&newsSpace);
+            }
+            else
+            {
+                vRwLockUpgradableUnlock(&newsSpace);
+            }
+        }
+
+        unsigned long hold = (holdStart != 0) ? ulGetRunTimeCounterValue() - holdStart : 0;
+
+        taskENTER_CRITICAL();
+
+        if (held == pdFALSE)
+        {
+            upgradeStats.skips++;
+        }
+        else
+        {
+            upgradeStats.decisions++;
+            upgradeStats.changes += (change ? 1U : 0U);
+
+            if (holdStart != 0)
+            {
+                upgradeStats.exclusiveTotal += hold;
+                vHistogramRecord(&upgradeStats.exclusiveHold, hold);
+            }
+        }
+
+        taskEXIT_CRITICAL();
+    }
+
+    xSemaphoreGive(benchDone);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+/* Changes the newspaper every COALESCE_PERIOD, taking the write lock itself or
+ * queueing the change for the batching writer */
+static void prvProducerTask( void * pvParameters )
+{
+    NewsChange_t change = { (uint32_t) (uintptr_t) pvParameters, 0 };
+    uint64_t csUnits = ullWorkUnitsForUs(xDemoConfig.ulCriticalSectionLength);
+    TickType_t wakeTime = xTaskGetTickCount();
+
+    while (benchRunning == pdTRUE)
+    {
+        xTaskDelayUntil(&wakeTime, COALESCE_PERIOD);
+        change.sequence++;
+
+        if (coalesceBatched)
+        {
+            /* Never waits - a full queue drops the change */
+            xWriteBatcherSubmit(&newsBatcher, &change);
+        }
+        else if (writeLockNews(BENCH_LOCK_TIMEOUT))
+        {
+            updateNewspaper(csUnits);
+            writeUnlockNews();
+
+            taskENTER_CRITICAL();
+            coalesceDirectChanges++;
+            taskEXIT_CRITICAL();
+        }
+        else
+        {
+            taskENTER_CRITICAL();
+            coalesceDirectSkips++;
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    xSemaphoreGive(benchDone);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+/* A reader or a writer of the workload: every tick, runs the operations due
+ * by then at its share of --op-rate */
+static void prvWorkloadTask( void * pvParameters )
+{
+    UBaseType_t index = (UBaseType_t) (uintptr_t) pvParameters;
+    BaseType_t reader = index < xDemoConfig.uxReaderCount;
+    uint64_t csUnits = ullWorkUnitsForUs(xDemoConfig.ulCriticalSectionLength);
+    uint32_t percent = reader ? xDemoConfig.ulReadPercent : 100U - xDemoConfig.ulReadPercent;
+    UBaseType_t peers = reader ? xDemoConfig.uxReaderCount : xDemoConfig.uxWriterCount;
+    double opsPerCount = (double) xDemoConfig.ulOpRate * percent / 100.0 / (double) peers / (double) runtimeCOUNTS_PER_SECOND;
+    uint64_t done = 0;
+    TickType_t wakeTime = xTaskGetTickCount();
+
+    while (benchRunning == pdTRUE)
+    {
+        xTaskDelayUntil(&wakeTime, 1);
+
+        uint64_t due = (uint64_t) ((double) (ulGetRunTimeCounterValue() - workloadStart) * opsPerCount);
+
+        if (due > done + WORKLOAD_MAX_BACKLOG)
+        {
+            taskENTER_CRITICAL();
+            workloadStats.missed += (uint32_t) (due - done - WORKLOAD_MAX_BACKLOG);
+            taskEXIT_CRITICAL();
+            done = due - WORKLOAD_MAX_BACKLOG;
+        }
+
+        for ( ; (done < due) && (benchRunning == pdTRUE); done++)
+        {
+            unsigned long start = ulGetRunTimeCounterValue();
+            BaseType_t locked;
+
+            if (reader)
+            {
+                locked = readLockNews(index, BENCH_LOCK_TIMEOUT);
+
+                if (locked)
+                {
+                    vWorkBurnUnits(csUnits);
+                    configASSERT(currentNewspaper()->text[ 0 ] == 'E');
+                    readUnlockNews(index);
+                }
+            }
+            else
+            {
+                locked = writeLockNews(BENCH_LOCK_TIMEOUT);
+
+                if (locked)
+                {
+                    updateNewspaper(csUnits);
+                    writeUnlockNews();
+                }
+            }
+
+            unsigned long latency = ulGetRunTimeCounterValue() - start;
+
+            taskENTER_CRITICAL();
+
+            if (!locked)
+            {
+                workloadStats.timeouts++;
+            }
+            else if (reader)
+            {
+                workloadStats.reads++;
+                vHistogramRecord(&workloadStats.readLatency, latency);
+            }
+            else
+            {
+                workloadStats.writes++;
+                vHistogramRecord(&workloadStats.writeLatency, latency);
+            }
+
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    xSemaphoreGive(benchDone);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
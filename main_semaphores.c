@@ -52,34 +52,43 @@
 
 /* Local includes. */
 #include "console.h"
+#include "demo_config.h"
+#include "latency_histogram.h"
+#include "work_units.h"
+#include "task_signal.h"
+#include "barrier.h"
+#include "adaptive_semaphore.h"
+#include "try_take.h"
+#include "periodic_task.h"
+#include "run_time_stats.h"
+#include "sem_profiler.h"
 
-/* Priorities at which the tasks are created. */
+/* Priorities at which the tasks are created.  The supervisor sits above the
+ * workers so that it can stop them at the end of a pattern run. */
 #define TASK1_PRIORITY    ( tskIDLE_PRIORITY + 1 )
 #define TASK2_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#define SUPERVISOR_PRIORITY    ( configMAX_PRIORITIES - 1 )
 
 /* The rate at which data is sent to the queue.  The times are converted from
  * milliseconds to ticks using the pdMS_TO_TICKS() macro. */
 #define TASK1_1S_PERIOD           pdMS_TO_TICKS( 1000UL )
-/* 1.9s to "simulate" drifting of a task execution */
-#define TASK2_2S_PERIOD           pdMS_TO_TICKS( 1900UL ) 
+/* The periods no longer drift by the execution time - see periodic_task.h */
+#define TASK2_2S_PERIOD           pdMS_TO_TICKS( 2000UL )
 #define A_100_MS_DELAY            pdMS_TO_TICKS( 100UL )
+/* How long Task2 keeps mainSemaphore, well inside its period so that its
+ * jobs do not overrun and Task1 gets its turn */
+#define TASK2_HOLD_TIME           ( 5 * A_100_MS_DELAY )
 
 
 /* The values sent to the queue receive task from the queue send task and the
  * queue send software timer respectively. */
 #define TASK1_STACK_SIZE        ( 1000UL )
 #define TASK2_STACK_SIZE        ( 1000UL )
+#define SUPERVISOR_STACK_SIZE   ( 1000UL )
+#define CONTENTION_STACK_SIZE   ( 1000UL )
 
-/* Activation of semaphore patterns - only one at a time can be active  */
-#undef BINARY_SEMAPHORES    
-#undef COUNTING_SEMAPHORES 
-#undef MUTEX_PATTERN        
-#undef RENDEZ_VOUS_PATTERN 
-
-/* Throw an error in case multiple patterns are active by mistake */
-#if defined(COUNTING_SEMAPHORES) && defined(MUTEX_PATTERN) && defined(BINARY_SEMAPHORES)
-    #error "Only one pattern at a time can be active! Please reduce this usage to 0 or 1"
-#endif
+/* The semaphore pattern is no longer chosen at compile time - see --pattern
+ * in demo_config.c.  Only one pattern at a time is active. */
 
 /*-----------------------------------------------------------*/
 
@@ -89,13 +98,196 @@
 static void prvTask1( void * pvParameters );
 static void prvTask2( void * pvParameters );
 
+/*
+ * The contention benchmark task - takes and gives mainSemaphore back to back.
+ */
+static void prvContentionTask( void * pvParameters );
+
+/*
+ * The publication benchmark tasks - the writers update printoutText every
+ * tick without ever blocking, the reader takes a consistent copy of it.
+ */
+static void prvPublishWriterTask( void * pvParameters );
+static void prvPublishReaderTask( void * pvParameters );
+
+/*
+ * The signal benchmark tasks - the signaller gives a signal every tick, the
+ * waiter, of higher priority, measures how long it took to wake up.
+ */
+static void prvSignallerTask( void * pvParameters );
+static void prvSignalWaiterTask( void * pvParameters );
+
+/*
+ * The barrier benchmark task - works, then waits for all the others.
+ */
+static void prvBarrierTask( void * pvParameters );
+
+/*
+ * The logging benchmark task - calls console_print() a few times every tick,
+ * timing each call.
+ */
+static void prvLoggingTask( void * pvParameters );
+
+/*
+ * Runs the selected pattern(s) one after the other, and reports their cost.
+ */
+static void prvSupervisorTask( void * pvParameters );
+
 /* No matter the pattern, the type is always the same */
 static SemaphoreHandle_t mainSemaphore = 0;
 
-#ifdef RENDEZ_VOUS_PATTERN
-static SemaphoreHandle_t task1Ready = 0;
-static SemaphoreHandle_t task2Ready = 0;
-#endif
+/* Releases of the Task1/Task2 jobs, indexed like workers[].  Each one is
+ * only updated by its own task, and reported once the workers are stopped. */
+static PeriodicTask_t workerPeriods[ demoMAX_WORKER_TASKS ];
+
+/* Task1 and Task2 try to take mainSemaphore through it, with the back-off
+ * policy of the run - see try_take.h */
+#define TRY_TAKE_MAX_RETRIES     ( 4UL )
+#define TRY_TAKE_BOUNDED_WAIT    ( A_100_MS_DELAY )
+static TryTakeSemaphore_t mainTryTake;
+static BackoffPolicy_t activeBackoff = eBackoffNone;
+
+/* Rendez-vous of the workers (up to barrierMAX_PARTIES of them), which all
+ * wait the same time for each other - see barrier.h */
+#define RENDEZ_VOUS_TIMEOUT    ( ( TickType_t ) 100 * A_100_MS_DELAY )
+static Barrier_t rendezVous;
+static UBaseType_t rendezVousParties = 0;
+
+/* Sequence of printoutText with the seqlock pattern - odd while a writer is
+ * copying into it.  Only accessed through the __atomic builtins. */
+static uint32_t textSequence = 0;
+
+/* Given by every worker task once it has left its loop. */
+static SemaphoreHandle_t workersDone = 0;
+
+/* The pattern currently run by the worker tasks, and whether they should
+ * keep running it. */
+static SemaphorePattern_t activePattern = ePatternNone;
+static volatile BaseType_t patternRunning = pdFALSE;
+static TaskHandle_t workers[ demoMAX_WORKER_TASKS ];
+static UBaseType_t workerCount = 0;
+
+/* Measurements of one pattern run.  Updated by the workers inside a critical
+ * section, and read by the supervisor once the workers are stopped. */
+typedef struct PatternStats
+{
+    uint32_t ulTakeAttempts;    /* Calls to xTryTake( &mainTryTake ). */
+    uint32_t ulTakes;           /* Successful takes - each one is given back. */
+    uint32_t ulFailures;        /* Busy semaphore, retried or not. */
+    uint32_t ulLost;            /* Updates dropped once the back-off policy gave up. */
+    uint32_t ulUpdates;         /* Copies made into printoutText. */
+    unsigned long ulWaitTotal;  /* Time spent in xSemaphoreTake(), run time counter units. */
+    unsigned long ulWaitMax;
+    unsigned long ulElapsed;    /* Length of the run. */
+} PatternStats_t;
+
+static PatternStats_t patternStats[ eBackoffCount ][ ePatternAll ];
+
+/* Wait (take called -> semaphore obtained) and hold (obtained -> given back)
+ * times of the contention benchmark, per priority of the taking task. */
+typedef struct ContentionStats
+{
+    LatencyHistogram_t wait;
+    LatencyHistogram_t hold;
+} ContentionStats_t;
+
+static ContentionStats_t contentionStats[ configMAX_PRIORITIES ];
+static ContentionStats_t contentionTotal;
+
+/* One line of the summary printed at the end of the benchmark. */
+typedef struct ContentionResult
+{
+    SemaphorePattern_t pattern;
+    BaseType_t adaptive;
+    UBaseType_t tasks;
+    double opsPerSecond;
+    uint64_t waitP50, waitP99, waitP999, waitMax;
+    uint64_t holdP50, holdMax;
+} ContentionResult_t;
+
+/* 3 patterns, each run with up to 7 task counts (1 .. 64), with plain and
+ * with adaptive takes */
+#define MAX_CONTENTION_RESULTS    ( 3 * 7 * 2 )
+static ContentionResult_t contentionResults[ MAX_CONTENTION_RESULTS ];
+static UBaseType_t contentionResultCount = 0;
+
+/* mainSemaphore behind the spin-then-block wrapper, used by the contention
+ * benchmark instead of plain blocking takes when contentionAdaptive is set */
+static AdaptiveSemaphore_t adaptiveMain;
+static BaseType_t contentionAdaptive = pdFALSE;
+
+/* Measurements of the publication benchmark, one entry per pattern. */
+typedef struct PublishStats
+{
+    uint32_t published;     /* Updates that made it into printoutText. */
+    uint32_t skipped;       /* Updates dropped because the writer could not get in. */
+    uint32_t reads;
+    uint32_t torn;          /* Copies that were neither of the texts. */
+    uint32_t retries;       /* Seqlock reads started again. */
+    LatencyHistogram_t readLatency;
+} PublishStats_t;
+
+static PublishStats_t publishStats[ ePatternAll ];
+
+/* The two signal implementations compared by the signal benchmark, the
+ * one in use, and the time the last signal was given at. */
+static SemaphoreSignal_t benchSemaphoreSignal;
+static NotifySignal_t benchNotifySignal;
+static BaseType_t benchUsesNotify = pdFALSE;
+static volatile unsigned long signalGivenAt = 0;
+static LatencyHistogram_t signalLatency[ 2 ];
+
+/* The barrier benchmark: the barrier cycled through, the releases seen in
+ * the current cycle, and the skew between the first and the last of them. */
+static Barrier_t benchBarrier;
+static UBaseType_t cycleReleases = 0;
+static unsigned long cycleFirstRelease = 0;
+static unsigned long cycleLastRelease = 0;
+static LatencyHistogram_t releaseSkew;
+
+/* A party still working when the run ends misses the abort of stopWorkers(),
+ * and waits for parties that are gone: it gives up after barrierWaitTimeout
+ * and notices the end of the run.  Set by runBarrier() well above the time
+ * the parties take to burn their work one after the other, so that no cycle
+ * is cut short during the run. */
+static TickType_t barrierWaitTimeout;
+
+typedef struct BarrierResult
+{
+    UBaseType_t tasks;
+    uint64_t cycles;
+    uint64_t skewP50, skewP99, skewP999, skewMax;
+} BarrierResult_t;
+
+/* 2, 4, 8, 16 and 24 tasks at most */
+#define MAX_BARRIER_RESULTS    ( 5 )
+static BarrierResult_t barrierResults[ MAX_BARRIER_RESULTS ];
+static UBaseType_t barrierResultCount = 0;
+
+/* The logging benchmark: cost of each console_print() call, per worker so
+ * that no lock is taken around the measurement, in the mode being run. */
+#define LOGGING_CALLS_PER_TICK    ( 4 )
+static LatencyHistogram_t loggingLatency[ demoMAX_WORKER_TASKS ];
+
+typedef struct LoggingResult
+{
+    ConsoleMode_t mode;
+    BaseType_t taskBuffers;
+    uint64_t calls;
+    uint32_t dropped;
+    uint32_t writes;
+    uint64_t lockWait;
+    uint64_t p50, p99, p999, max, mean;
+} LoggingResult_t;
+
+/* sync, drop through the ring, drop and binary through the task buffers */
+#define MAX_LOGGING_RESULTS    ( 4 )
+static LoggingResult_t loggingResults[ MAX_LOGGING_RESULTS ];
+static UBaseType_t loggingResultCount = 0;
+
+/* Past that many retries a seqlock reader sleeps for a tick instead of
+ * yielding, so that a writer of lower priority can finish its copy. */
+#define SEQLOCK_YIELD_RETRIES    ( 8 )
 
 /*-----------------------------------------------------------*/
 /* Maximum size of variable*/
@@ -111,18 +303,116 @@ static char printoutText[MAX_STRING_SIZE];
 
 void slowStringCopy(char* dest, char* src, int textSize)
 {
-    int i,max = 0;
+    int i = 0, max = 0;
 
     /* Let's reset the content of the destination to '\0' - so no need to set it later*/
     memset(dest, '\0', MAX_STRING_SIZE);
     /* Make sure we do not overflow */
     max = ( textSize < MAX_STRING_SIZE) ? textSize : MAX_STRING_SIZE - 1;
+    if (max <= 0) return;
+
+    /* Let's make a slow copy - the --cs-length microseconds of calibrated
+     * work are spread over the characters, and cannot be optimized away */
+    uint64_t workPerCharacter = ullWorkUnitsForUs(xDemoConfig.ulCriticalSectionLength) / max;
     while (i < max)
     {
         dest[i] =  src[i];
         i++;
-        /* Let's make a slow copy - is this really working or optimized by the compiler? ;-) */
-        for(long long k=0; k<9223372036854775807;k++){};
+        vWorkBurnUnits(workPerCharacter);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t patternUsesMainSemaphore( SemaphorePattern_t pattern )
+{
+    return ( pattern == ePatternBinary ) ||
+           ( pattern == ePatternCounting ) ||
+           ( pattern == ePatternMutex );
+}
+/*-----------------------------------------------------------*/
+
+/* Try-take of mainSemaphore, accounting for the time spent in it (back-off
+ * included) */
+static BaseType_t takeMainSemaphore( void )
+{
+    PatternStats_t * stats = &patternStats[ activeBackoff ][ activePattern ];
+    unsigned long start = ulGetRunTimeCounterValue();
+    BaseType_t taken = xTryTake(&mainTryTake);
+    unsigned long wait = ulGetRunTimeCounterValue() - start;
+
+    taskENTER_CRITICAL();
+    {
+        stats->ulTakeAttempts++;
+        stats->ulWaitTotal += wait;
+        if (wait > stats->ulWaitMax) stats->ulWaitMax = wait;
+        if (taken == pdTRUE) stats->ulTakes++;
+    }
+    taskEXIT_CRITICAL();
+
+    return taken;
+}
+/*-----------------------------------------------------------*/
+
+static void countUpdate( void )
+{
+    taskENTER_CRITICAL();
+    patternStats[ activeBackoff ][ activePattern ].ulUpdates++;
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+/* Seqlock writer side: never blocks.  Returns pdFALSE, and the update is
+ * skipped, if another writer is publishing at the same moment */
+static BaseType_t seqlockPublish( char * src, int textSize )
+{
+    uint32_t sequence = __atomic_load_n(&textSequence, __ATOMIC_RELAXED);
+
+    if ((sequence & 1U) != 0 ||
+        !__atomic_compare_exchange_n(&textSequence, &sequence, sequence + 1U, pdFALSE,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        return pdFALSE;
+    }
+
+    /* The odd sequence must be visible before any character changes */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slowStringCopy(&printoutText[0], src, textSize);
+    __atomic_store_n(&textSequence, sequence + 2U, __ATOMIC_RELEASE);
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/* Seqlock reader side: copies printoutText into dest, starting again as long
+ * as a writer was active during the copy.  Returns the number of retries */
+static uint32_t seqlockRead( char * dest )
+{
+    uint32_t retries = 0;
+
+    for ( ; ; )
+    {
+        uint32_t sequence = __atomic_load_n(&textSequence, __ATOMIC_ACQUIRE);
+
+        if ((sequence & 1U) == 0)
+        {
+            memcpy(dest, printoutText, MAX_STRING_SIZE);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            if (__atomic_load_n(&textSequence, __ATOMIC_RELAXED) == sequence)
+            {
+                return retries;
+            }
+        }
+
+        /* A writer is in the middle of its copy - let it finish */
+        if (++retries < SEQLOCK_YIELD_RETRIES)
+        {
+            taskYIELD();
+        }
+        else
+        {
+            vTaskDelay(1);
+        }
     }
 }
 /*-----------------------------------------------------------*/
@@ -133,167 +423,1207 @@ void main_semaphores( void )
     memset(&printoutText, 0, sizeof(printoutText));
     strncpy(&printoutText[0], anInitialText, MAX_STRING_SIZE);
 
-#ifdef BINARY_SEMAPHORES
-    mainSemaphore = xSemaphoreCreateBinary();
-#elif defined(COUNTING_SEMAPHORES)
-    /* Initialize the semaphore to max_value of 1 and initial value of 1 */
-    mainSemaphore = xSemaphoreCreateCounting(1, 1);
-#elif defined(MUTEX_PATTERN)
-    /* Initialize the semaphore to max_value of 1 and initial value of 1 */
-    mainSemaphore = xSemaphoreCreateMutex();
-#endif    
-    if (mainSemaphore == 0) 
-    {
-        printf("Resouce not created\n");
-    }
-/* Calling give() is only necessary on binary semaphores as their initial value is 0 */    
-#ifdef BINARY_SEMAPHORES
-    else
-    {
-            /* Semaphore needs to be given once so as to make the system work*/  
-            xSemaphoreGive(mainSemaphore);
-    }
-#endif
-
-#ifdef RENDEZ_VOUS_PATTERN
-    /* Initialize the semaphores to max_value of 1 and initial value of 1 */
-    task1Ready = xSemaphoreCreateCounting(1, 1);
-    task2Ready = xSemaphoreCreateCounting(1, 1);
-#endif 
+    workersDone = xSemaphoreCreateCounting(demoMAX_WORKER_TASKS, 0);
 
     /* Print out the initial message */
-    printf("%s \n", &aBanner[0]); 
-    printf("The initial sentence printed out is: %s \n", &printoutText[0]); 
-    printf("%s \n", &aBanner[0]); 
+    console_print("%s \n", &aBanner[0]); 
+    console_print("The initial sentence printed out is: %s \n", &printoutText[0]); 
+    console_print("%s \n", &aBanner[0]); 
 
-    /* Start the two tasks as described in the comments at the top of this
-     * file. */
-    xTaskCreate( prvTask1           ,             /* The function that implements the task. */
-                  "Task1",                         /* The text name assigned to the task - for debug only as it is not used by the kernel. */
-                  TASK1_STACK_SIZE,                /* The size of the stack to allocate to the task. */
-                  NULL,                            /* The parameter passed to the task - not used in this simple case. */
-                  TASK1_PRIORITY, /* The priority assigned to the task. */
-                  NULL );                          /* The task handle is not required, so NULL is passed. */
-
-    xTaskCreate( prvTask2           ,             /* The function that implements the task. */
-                 "Task2",                         /* The text name assigned to the task - for debug only as it is not used by the kernel. */
-                 TASK2_STACK_SIZE,                /* The size of the stack to allocate to the task. */
-                 NULL,                            /* The parameter passed to the task - not used in this simple case. */
-                 TASK2_PRIORITY, /* The priority assigned to the task. */
-                 NULL );                          /* The task handle is not required, so NULL is passed. */
+    /* The supervisor creates Task1 and Task2 - as described in the comments
+     * at the top of this file - once per pattern. */
+    xTaskCreate( prvSupervisorTask,
+                 "Supervisor",
+                 SUPERVISOR_STACK_SIZE,
+                 NULL,
+                 SUPERVISOR_PRIORITY,
+                 NULL );
 
     /* Start the tasks and timer running. */
     vTaskStartScheduler();  
 
     /* If all is well, the scheduler will now be running, and the following
-     * line will never be reached.  If the following line does execute, then
-     * there was insufficient FreeRTOS heap memory available for the idle and/or
-     * timer tasks	to be created.  See the memory management section on the
+     * line will only be reached once the supervisor has ended the scheduler
+     * after the last pattern.  If it is reached earlier, then there was
+     * insufficient FreeRTOS heap memory available for the idle and/or timer
+     * tasks	to be created.  See the memory management section on the
      * FreeRTOS web site for more details. */
-    for( ; ; )
+}
+
+/*-----------------------------------------------------------*/
+
+static void createPatternSemaphores( SemaphorePattern_t pattern )
+{
+    __atomic_store_n(&textSequence, 0, __ATOMIC_RELAXED);
+
+    if (pattern == ePatternBinary)
+    {
+        mainSemaphore = xSemaphoreCreateBinary();
+    }
+    else if (pattern == ePatternCounting)
+    {
+        /* Initialize the semaphore to max_value of 1 and initial value of 1 */
+        mainSemaphore = xSemaphoreCreateCounting(1, 1);
+    }
+    else if (pattern == ePatternMutex)
+    {
+        mainSemaphore = xSemaphoreCreateMutex();
+    }
+
+    if (mainSemaphore != 0)
+    {
+        vSemProfilerRegister(mainSemaphore, "mainSemaphore");
+    }
+
+    if (patternUsesMainSemaphore(pattern) && (mainSemaphore == 0))
     {
+        console_print("Resouce not created\n");
+    }
+    /* Calling give() is only necessary on binary semaphores as their initial value is 0 */
+    else if (pattern == ePatternBinary)
+    {
+        /* Semaphore needs to be given once so as to make the system work*/  
+        xSemaphoreGive(mainSemaphore);
     }
 }
+/*-----------------------------------------------------------*/
+
+/* Ends the run of the workers, and deletes the semaphores they used */
+static void stopWorkers( void )
+{
+    patternRunning = pdFALSE;
+
+    /* The workers run at a lower priority, so none of them can have deleted
+     * itself yet.  Wake up the ones that are delayed or blocked on a semaphore
+     * so that they notice the end of the run without waiting a full period. */
+    for (UBaseType_t x = 0; x < workerCount; x++)
+    {
+        xTaskAbortDelay(workers[ x ]);
+    }
+
+    for (UBaseType_t x = 0; x < workerCount; x++)
+    {
+        xSemaphoreTake(workersDone, portMAX_DELAY);
+        workers[ x ] = NULL;
+    }
+
+    workerCount = 0;
+
+    if (mainSemaphore != 0)
+    {
+        vSemaphoreDelete(mainSemaphore);
+        mainSemaphore = 0;
+    }
+
+    if (rendezVousParties > 0)
+    {
+        vBarrierDelete(&rendezVous);
+        rendezVousParties = 0;
+    }
 
+    /* Give the idle task a chance to free the deleted workers */
+    vTaskDelay(A_100_MS_DELAY);
+}
 /*-----------------------------------------------------------*/
 
-static void prvTask1(void * pvParameters )
+static void startPattern( SemaphorePattern_t pattern, BackoffPolicy_t backoff )
 {
-     /* Prevent the compiler warning about the unused parameter. */
-    ( void ) pvParameters;
-    
-    /* Local variables*/
-    int textLength = strlen(littleRedHatText);
+    char taskName[ configMAX_TASK_NAME_LEN ];
+    PatternStats_t * stats = &patternStats[ backoff ][ pattern ];
 
-    /* Announce task is ready */   
-    printf("\nThis is task 1 - launching\n" );
-    fflush(stdout);
+    memset(stats, 0, sizeof(PatternStats_t));
+    activePattern = pattern;
+    activeBackoff = backoff;
+    createPatternSemaphores(pattern);
+    vTryTakeInit(&mainTryTake, mainSemaphore, "mainSemaphore", backoff,
+                 TRY_TAKE_MAX_RETRIES, TRY_TAKE_BOUNDED_WAIT);
 
-#ifdef RENDEZ_VOUS_PATTERN
-    /* Add delay to represent some long lasting activity */
-    vTaskDelay(100 * A_100_MS_DELAY);
-    
-    /* Signal readiness and wait for the other task to be done */
-    xSemaphoreGive(task1Ready);
-    xSemaphoreTake(task2Ready, ( TickType_t ) 100 * A_100_MS_DELAY);
-    printf("\nThis is task 1 - Rendez-vous : we are ready!\n\n" );
-#endif
-    int swapTick = 0;
+    console_print("\nRunning pattern '%s' with %u task(s), back-off '%s'\n",
+                  pcDemoPatternName(pattern), (unsigned) xDemoConfig.uxTaskCount,
+                  pcBackoffPolicyName(backoff));
+
+    patternRunning = pdTRUE;
+    stats->ulElapsed = ulGetRunTimeCounterValue();
 
-    for( ; ; )
+    /* Start the two tasks as described in the comments at the top of this
+     * file - additional tasks alternate between the two workloads. */
+    workerCount = xDemoConfig.uxTaskCount;
+
+    for (UBaseType_t x = 0; x < workerCount; x++)
     {
-        /* Print out the message */
-        /* console_print( "This is task 1\n" ); */
+        snprintf(taskName, sizeof(taskName), "Task%u", (unsigned) (x + 1));
 
-        /* Copy text & printout - let's make sure there is no overrun */
-        if (1 == swapTick )
+        /* Blank until the task has released its first job */
+        memset(&workerPeriods[ x ], 0, sizeof(PeriodicTask_t));
+
+        if ((x % 2) == 0)
         {
-  
-            swapTick = 0;
-#if defined(BINARY_SEMAPHORES) || defined(COUNTING_SEMAPHORES) || defined(MUTEX_PATTERN)
-            /* If we can get the semaphore, we change the string */
-            if (xSemaphoreTake(mainSemaphore, ( TickType_t ) 0))
-            {
-                slowStringCopy(&printoutText[0], littleRedHatText, textLength);
-                xSemaphoreGive(mainSemaphore);
-            }        
-#else        
-            slowStringCopy(&printoutText[0], littleRedHatText, textLength);
-#endif
-        } else
+            xTaskCreate( prvTask1           ,             /* The function that implements the task. */
+                          taskName,                        /* The text name assigned to the task - for debug only as it is not used by the kernel. */
+                          TASK1_STACK_SIZE,                /* The size of the stack to allocate to the task. */
+                          (void *) (uintptr_t) x,          /* The parameter passed to the task - its index among the workers. */
+                          TASK1_PRIORITY, /* The priority assigned to the task. */
+                          &workers[ x ] );                 /* Kept so the supervisor can wake the task up when stopping. */
+        }
+        else
         {
-            swapTick++;
+            xTaskCreate( prvTask2           ,             /* The function that implements the task. */
+                         taskName,                        /* The text name assigned to the task - for debug only as it is not used by the kernel. */
+                         TASK2_STACK_SIZE,                /* The size of the stack to allocate to the task. */
+                         (void *) (uintptr_t) x,          /* The parameter passed to the task - its index among the workers. */
+                         TASK2_PRIORITY, /* The priority assigned to the task. */
+                         &workers[ x ] );                 /* Kept so the supervisor can wake the task up when stopping. */
         }
-        printf("The sentence is: %s \n", &printoutText[0]);
-        fflush(stdout); 
-        vTaskDelay(TASK1_1S_PERIOD);
+    }
+
+    /* The workers have a lower priority, so none of them runs before the
+     * barrier exists */
+    if (pattern == ePatternRendezVous)
+    {
+        rendezVousParties = (workerCount < barrierMAX_PARTIES) ? workerCount : barrierMAX_PARTIES;
+        vBarrierCreate(&rendezVous, rendezVousParties);
+        vSemProfilerRegisterEventGroup(rendezVous.xEventGroup, "rendezVous");
     }
 }
+/*-----------------------------------------------------------*/
+
+/* Release jitter, response times and overruns of the jobs of the workers
+ * that just stopped */
+static void reportPeriods( UBaseType_t count )
+{
+    char names[ demoMAX_WORKER_TASKS ][ configMAX_TASK_NAME_LEN ];
+    const char * nameList[ demoMAX_WORKER_TASKS ];
+    const PeriodicTask_t * periodList[ demoMAX_WORKER_TASKS ];
 
+    for (UBaseType_t x = 0; x < count; x++)
+    {
+        snprintf(names[ x ], sizeof(names[ x ]), "Task%u", (unsigned) (x + 1));
+        nameList[ x ] = names[ x ];
+        periodList[ x ] = &workerPeriods[ x ];
+    }
 
+    vPeriodicTaskReport(nameList, periodList, count);
+}
 /*-----------------------------------------------------------*/
 
-static void prvTask2(void * pvParameters )
+static void stopPattern( SemaphorePattern_t pattern, BackoffPolicy_t backoff )
 {
-    /* Prevent the compiler warning about the unused parameter. */
-    ( void ) pvParameters;
-    
-    /* Local variables*/
-    int textLength = strlen(dressedUpWolfText);
+    PatternStats_t * stats = &patternStats[ backoff ][ pattern ];
+    UBaseType_t count = workerCount;
 
-    /* Announce task is ready */
-    printf("\nThis is task 2 - launching\n" );
-    fflush(stdout);
+    stats->ulElapsed = ulGetRunTimeCounterValue() - stats->ulElapsed;
+
+    /* The semaphore goes with the workers */
+    if (patternUsesMainSemaphore(pattern))
+    {
+        stats->ulFailures = mainTryTake.xTotal.ulFailures;
+        stats->ulLost = mainTryTake.xTotal.ulLost;
+        vTryTakeReport(&mainTryTake);
+    }
 
-#ifdef RENDEZ_VOUS_PATTERN
-    /* Add delay to represent some long lasting activity */
-    vTaskDelay(100 * A_100_MS_DELAY);    
+    stopWorkers();
+    reportPeriods(count);
+}
+/*-----------------------------------------------------------*/
 
-    /* Signal readiness and wait for the other task to be done */
-    xSemaphoreGive(task2Ready);
-    xSemaphoreTake(task1Ready, ( TickType_t ) 10 * A_100_MS_DELAY);
-    printf("\nThis is task 1 - Rendez-vous : we are ready!\n\n" );
-#endif 
+static void reportPatterns( SemaphorePattern_t first, SemaphorePattern_t last,
+                            BackoffPolicy_t firstBackoff, BackoffPolicy_t lastBackoff )
+{
+    console_print("\n%-10s %-11s %5s %10s %10s %10s %10s %10s %12s %12s %12s\n",
+                  "Pattern", "Back-off", "Tasks", "Attempts", "Takes", "Failures", "Lost", "Updates",
+                  "Takes/s", "Wait avg " runtimeUNIT_NAME, "Wait max " runtimeUNIT_NAME);
 
-    for( ; ; )
+    for (BackoffPolicy_t backoff = firstBackoff; backoff <= lastBackoff; backoff++)
     {
-#if defined(BINARY_SEMAPHORES) || defined(COUNTING_SEMAPHORES) || defined(MUTEX_PATTERN)
-        /* If we can get the semaphore, we change the string */
-        if (xSemaphoreTake(mainSemaphore, ( TickType_t ) 0))
+        for (SemaphorePattern_t pattern = first; pattern <= last; pattern++)
         {
-            slowStringCopy(&printoutText[0], dressedUpWolfText, textLength);
-            /* As this task is subject to the task as far as printing is concerned  */
-            /* let's hold the semaphore a little longer for ensuring our string is  */
-            /* visible */
-            vTaskDelay(5*TASK1_FREQUENCY_MS);
-            xSemaphoreGive(mainSemaphore);
-        } 
-#else                
-        slowStringCopy(&printoutText[0], dressedUpWolfText, textLength);
-#endif        
-     
-        vTaskDelay(TASK2_2S_PERIOD);
+            const PatternStats_t * stats = &patternStats[ backoff ][ pattern ];
+            double seconds = (double) stats->ulElapsed / (double) runtimeCOUNTS_PER_SECOND;
+            unsigned long waitAverage = (stats->ulTakeAttempts > 0) ? stats->ulWaitTotal / stats->ulTakeAttempts : 0;
+
+            console_print("%-10s %-11s %5u %10lu %10lu %10lu %10lu %10lu %12.2f %12lu %12lu\n",
+                          pcDemoPatternName(pattern),
+                          pcBackoffPolicyName(backoff),
+                          (unsigned) xDemoConfig.uxTaskCount,
+                          (unsigned long) stats->ulTakeAttempts,
+                          (unsigned long) stats->ulTakes,
+                          (unsigned long) stats->ulFailures,
+                          (unsigned long) stats->ulLost,
+                          (unsigned long) stats->ulUpdates,
+                          (seconds > 0.0) ? (double) stats->ulTakes / seconds : 0.0,
+                          waitAverage,
+                          stats->ulWaitMax);
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void startContention( SemaphorePattern_t pattern, UBaseType_t tasks, BaseType_t adaptive )
+{
+    char taskName[ configMAX_TASK_NAME_LEN ];
+
+    for (UBaseType_t x = 0; x < configMAX_PRIORITIES; x++)
+    {
+        vHistogramReset(&contentionStats[ x ].wait);
+        vHistogramReset(&contentionStats[ x ].hold);
+    }
+
+    activePattern = pattern;
+    createPatternSemaphores(pattern);
+    vAdaptiveSemaphoreInit(&adaptiveMain, mainSemaphore);
+    contentionAdaptive = adaptive;
+    patternRunning = pdTRUE;
+    workerCount = tasks;
+
+    for (UBaseType_t x = 0; x < workerCount; x++)
+    {
+        snprintf(taskName, sizeof(taskName), "Cont%u", (unsigned) (x + 1));
+        xTaskCreate( prvContentionTask,
+                     taskName,
+                     CONTENTION_STACK_SIZE,
+                     NULL,
+                     xDemoConfig.uxPriorities[ x % xDemoConfig.uxPriorityCount ],
+                     &workers[ x ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void reportContentionRow( const char * label, const ContentionStats_t * stats )
+{
+    console_print("%-8s %10llu %10llu %10llu %10llu %10llu | %10llu %10llu %10llu %10llu\n",
+                  label,
+                  (unsigned long long) stats->wait.ullCount,
+                  (unsigned long long) ullHistogramPercentile(&stats->wait, 50.0),
+                  (unsigned long long) ullHistogramPercentile(&stats->wait, 99.0),
+                  (unsigned long long) ullHistogramPercentile(&stats->wait, 99.9),
+                  (unsigned long long) stats->wait.ullMax,
+                  (unsigned long long) ullHistogramPercentile(&stats->hold, 50.0),
+                  (unsigned long long) ullHistogramPercentile(&stats->hold, 99.0),
+                  (unsigned long long) ullHistogramPercentile(&stats->hold, 99.9),
+                  (unsigned long long) stats->hold.ullMax);
+}
+/*-----------------------------------------------------------*/
+
+static void runContention( SemaphorePattern_t pattern, UBaseType_t tasks, BaseType_t adaptive )
+{
+    char label[ 16 ];
+    unsigned long elapsed = ulGetRunTimeCounterValue();
+
+    startContention(pattern, tasks, adaptive);
+    vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+    elapsed = ulGetRunTimeCounterValue() - elapsed;
+    stopWorkers();
+
+    vHistogramReset(&contentionTotal.wait);
+    vHistogramReset(&contentionTotal.hold);
+
+    console_print("\nContention on '%s' with %u task(s)%s - times in run time counter units (" runtimeUNIT_NAME ")\n",
+                  pcDemoPatternName(pattern), (unsigned) tasks, adaptive ? ", spin-then-block takes" : "");
+
+    if (adaptive)
+    {
+        console_print("Takes: %lu immediate, %lu while spinning, %lu blocking - final spin budget %lu\n",
+                      (unsigned long) adaptiveMain.ulImmediate,
+                      (unsigned long) adaptiveMain.ulSpinAcquired,
+                      (unsigned long) adaptiveMain.ulBlockAcquired,
+                      ulAdaptiveSemaphoreSpinBudget(&adaptiveMain));
+    }
+
+    console_print("%-8s %10s %10s %10s %10s %10s | %10s %10s %10s %10s\n",
+                  "Priority", "Takes", "Wait p50", "p99", "p99.9", "max", "Hold p50", "p99", "p99.9", "max");
+
+    for (UBaseType_t x = 0; x < configMAX_PRIORITIES; x++)
+    {
+        if (contentionStats[ x ].wait.ullCount > 0)
+        {
+            snprintf(label, sizeof(label), "%u", (unsigned) x);
+            reportContentionRow(label, &contentionStats[ x ]);
+            vHistogramMerge(&contentionTotal.wait, &contentionStats[ x ].wait);
+            vHistogramMerge(&contentionTotal.hold, &contentionStats[ x ].hold);
+        }
+    }
+
+    reportContentionRow("all", &contentionTotal);
+
+    if (contentionResultCount < MAX_CONTENTION_RESULTS)
+    {
+        ContentionResult_t * result = &contentionResults[ contentionResultCount++ ];
+
+        result->pattern = pattern;
+        result->adaptive = adaptive;
+        result->tasks = tasks;
+        result->opsPerSecond = (elapsed > 0) ? (double) contentionTotal.wait.ullCount * (double) runtimeCOUNTS_PER_SECOND / (double) elapsed : 0.0;
+        result->waitP50 = ullHistogramPercentile(&contentionTotal.wait, 50.0);
+        result->waitP99 = ullHistogramPercentile(&contentionTotal.wait, 99.0);
+        result->waitP999 = ullHistogramPercentile(&contentionTotal.wait, 99.9);
+        result->waitMax = contentionTotal.wait.ullMax;
+        result->holdP50 = ullHistogramPercentile(&contentionTotal.hold, 50.0);
+        result->holdMax = contentionTotal.hold.ullMax;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void runContentionBenchmark( SemaphorePattern_t first, SemaphorePattern_t last )
+{
+    for (SemaphorePattern_t pattern = first; pattern <= last; pattern++)
+    {
+        /* Sweeping doubles the number of tasks up to --tasks, the last run
+         * always uses exactly --tasks */
+        UBaseType_t tasks = (xDemoConfig.xSweepTasks == pdTRUE) ? 1 : xDemoConfig.uxTaskCount;
+
+        for ( ; ; )
+        {
+            runContention(pattern, tasks, pdFALSE);
+
+            /* Same run again, with the spin-then-block wrapper */
+            if (xDemoConfig.xBench == eBenchAdaptive)
+            {
+                runContention(pattern, tasks, pdTRUE);
+            }
+
+            if (tasks >= xDemoConfig.uxTaskCount)
+            {
+                break;
+            }
+
+            tasks = (tasks * 2 < xDemoConfig.uxTaskCount) ? tasks * 2 : xDemoConfig.uxTaskCount;
+        }
+    }
+
+    console_print("\n%-10s %-6s %5s %12s %10s %10s %10s %10s %10s %10s\n",
+                  "Pattern", "Take", "Tasks", "Ops/s", "Wait p50", "p99", "p99.9", "max", "Hold p50", "max");
+
+    for (UBaseType_t x = 0; x < contentionResultCount; x++)
+    {
+        const ContentionResult_t * result = &contentionResults[ x ];
+
+        console_print("%-10s %-6s %5u %12.1f %10llu %10llu %10llu %10llu %10llu %10llu\n",
+                      pcDemoPatternName(result->pattern),
+                      result->adaptive ? "spin" : "block",
+                      (unsigned) result->tasks,
+                      result->opsPerSecond,
+                      (unsigned long long) result->waitP50,
+                      (unsigned long long) result->waitP99,
+                      (unsigned long long) result->waitP999,
+                      (unsigned long long) result->waitMax,
+                      (unsigned long long) result->holdP50,
+                      (unsigned long long) result->holdMax);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t isWholeText( const char * text )
+{
+    return (strcmp(text, littleRedHatText) == 0) ||
+           (strcmp(text, dressedUpWolfText) == 0) ||
+           (strcmp(text, anInitialText) == 0);
+}
+/*-----------------------------------------------------------*/
+
+static void runPublish( SemaphorePattern_t pattern )
+{
+    char taskName[ configMAX_TASK_NAME_LEN ];
+
+    memset(&publishStats[ pattern ], 0, sizeof(PublishStats_t));
+    vHistogramReset(&publishStats[ pattern ].readLatency);
+    memset(&printoutText, 0, sizeof(printoutText));
+    strncpy(&printoutText[0], anInitialText, MAX_STRING_SIZE - 1);
+
+    activePattern = pattern;
+    createPatternSemaphores(pattern);
+    patternRunning = pdTRUE;
+    workerCount = xDemoConfig.uxTaskCount;
+
+    /* The first task reads, all the others write */
+    for (UBaseType_t x = 0; x < workerCount; x++)
+    {
+        snprintf(taskName, sizeof(taskName), (x == 0) ? "Reader" : "Writer%u", (unsigned) x);
+        xTaskCreate( (x == 0) ? prvPublishReaderTask : prvPublishWriterTask,
+                     taskName,
+                     CONTENTION_STACK_SIZE,
+                     (void *) (uintptr_t) x,
+                     xDemoConfig.uxPriorities[ x % xDemoConfig.uxPriorityCount ],
+                     &workers[ x ] );
     }
+
+    vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+    stopWorkers();
 }
 /*-----------------------------------------------------------*/
 
+static void runPublishBenchmark( SemaphorePattern_t first, SemaphorePattern_t last )
+{
+    for (SemaphorePattern_t pattern = first; pattern <= last; pattern++)
+    {
+        if (pattern != ePatternRendezVous)
+        {
+            runPublish(pattern);
+        }
+    }
+
+    console_print("\nPublication of printoutText, 1 reader and %u writer(s) - times in run time counter units (" runtimeUNIT_NAME ")\n",
+                  (unsigned) (xDemoConfig.uxTaskCount - 1));
+    console_print("%-10s %10s %10s %10s %8s %8s %10s %10s %10s %10s\n",
+                  "Pattern", "Published", "Skipped", "Reads", "Torn", "Retries", "Read p50", "p99", "p99.9", "max");
+
+    for (SemaphorePattern_t pattern = first; pattern <= last; pattern++)
+    {
+        const PublishStats_t * stats = &publishStats[ pattern ];
+
+        if (pattern == ePatternRendezVous)
+        {
+            continue;
+        }
+
+        console_print("%-10s %10lu %10lu %10lu %8lu %8lu %10llu %10llu %10llu %10llu\n",
+                      pcDemoPatternName(pattern),
+                      (unsigned long) stats->published,
+                      (unsigned long) stats->skipped,
+                      (unsigned long) stats->reads,
+                      (unsigned long) stats->torn,
+                      (unsigned long) stats->retries,
+                      (unsigned long long) ullHistogramPercentile(&stats->readLatency, 50.0),
+                      (unsigned long long) ullHistogramPercentile(&stats->readLatency, 99.0),
+                      (unsigned long long) ullHistogramPercentile(&stats->readLatency, 99.9),
+                      (unsigned long long) stats->readLatency.ullMax);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void runSignal( BaseType_t useNotify )
+{
+    vHistogramReset(&signalLatency[ useNotify ]);
+    benchUsesNotify = useNotify;
+    patternRunning = pdTRUE;
+    workerCount = 2;
+
+    xTaskCreate(prvSignalWaiterTask, "Waiter", CONTENTION_STACK_SIZE, NULL, TASK1_PRIORITY + 1, &workers[ 0 ]);
+    xTaskCreate(prvSignallerTask, "Signaller", CONTENTION_STACK_SIZE, NULL, TASK1_PRIORITY, &workers[ 1 ]);
+
+    /* Neither task runs before the signal exists - the supervisor has the
+     * highest priority */
+    if (useNotify)
+    {
+        vNotifySignalCreate(&benchNotifySignal, workers[ 0 ]);
+    }
+    else
+    {
+        vSemaphoreSignalCreate(&benchSemaphoreSignal, workers[ 0 ]);
+    }
+
+    vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+    stopWorkers();
+
+    if (useNotify)
+    {
+        vNotifySignalDelete(&benchNotifySignal);
+    }
+    else
+    {
+        vSemaphoreSignalDelete(&benchSemaphoreSignal);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void runSignalBenchmark( void )
+{
+    /* The notification state is part of every TCB whether it is used or
+     * not, so a NotifySignal_t costs nothing but the waiter's handle */
+    static const char * const names[ 2 ] = { "semaphore", "notification" };
+    const size_t sizes[ 2 ] = { sizeof(SemaphoreSignal_t), sizeof(NotifySignal_t) };
+
+    runSignal(pdFALSE);
+    runSignal(pdTRUE);
+
+    console_print("\nSignal to wake latency - times in run time counter units (" runtimeUNIT_NAME ")\n");
+    console_print("%-12s %10s %10s %10s %10s %10s %10s\n",
+                  "Mechanism", "Bytes/obj", "Wakes", "p50", "p99", "p99.9", "max");
+
+    for (int x = 0; x < 2; x++)
+    {
+        console_print("%-12s %10lu %10llu %10llu %10llu %10llu %10llu\n",
+                      names[ x ],
+                      (unsigned long) sizes[ x ],
+                      (unsigned long long) signalLatency[ x ].ullCount,
+                      (unsigned long long) ullHistogramPercentile(&signalLatency[ x ], 50.0),
+                      (unsigned long long) ullHistogramPercentile(&signalLatency[ x ], 99.0),
+                      (unsigned long long) ullHistogramPercentile(&signalLatency[ x ], 99.9),
+                      (unsigned long long) signalLatency[ x ].ullMax);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void runBarrier( UBaseType_t tasks )
+{
+    char taskName[ configMAX_TASK_NAME_LEN ];
+
+    vHistogramReset(&releaseSkew);
+    cycleReleases = 0;
+    vBarrierCreate(&benchBarrier, tasks);
+    barrierWaitTimeout = A_100_MS_DELAY +
+                         pdMS_TO_TICKS((uint64_t) 2 * tasks * xDemoConfig.ulCriticalSectionLength / 1000);
+    patternRunning = pdTRUE;
+    workerCount = tasks;
+
+    for (UBaseType_t x = 0; x < workerCount; x++)
+    {
+        snprintf(taskName, sizeof(taskName), "Party%u", (unsigned) x);
+        xTaskCreate( prvBarrierTask,
+                     taskName,
+                     CONTENTION_STACK_SIZE,
+                     (void *) (uintptr_t) x,
+                     xDemoConfig.uxPriorities[ x % xDemoConfig.uxPriorityCount ],
+                     &workers[ x ] );
+    }
+
+    vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+    stopWorkers();
+    vBarrierDelete(&benchBarrier);
+
+    if (barrierResultCount < MAX_BARRIER_RESULTS)
+    {
+        BarrierResult_t * result = &barrierResults[ barrierResultCount++ ];
+
+        result->tasks = tasks;
+        result->cycles = releaseSkew.ullCount;
+        result->skewP50 = ullHistogramPercentile(&releaseSkew, 50.0);
+        result->skewP99 = ullHistogramPercentile(&releaseSkew, 99.0);
+        result->skewP999 = ullHistogramPercentile(&releaseSkew, 99.9);
+        result->skewMax = releaseSkew.ullMax;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void runBarrierBenchmark( void )
+{
+    /* Sweeping doubles the number of tasks from 2 up to --tasks */
+    UBaseType_t tasks = (xDemoConfig.xSweepTasks == pdTRUE) ? 2 : xDemoConfig.uxTaskCount;
+
+    for ( ; ; )
+    {
+        runBarrier(tasks);
+
+        if (tasks >= xDemoConfig.uxTaskCount)
+        {
+            break;
+        }
+
+        tasks = (tasks * 2 < xDemoConfig.uxTaskCount) ? tasks * 2 : xDemoConfig.uxTaskCount;
+    }
+
+    console_print("\nBarrier release skew (first to last task released) - times in run time counter units (" runtimeUNIT_NAME ")\n");
+    console_print("%5s %10s %10s %10s %10s %10s\n", "Tasks", "Cycles", "Skew p50", "p99", "p99.9", "max");
+
+    for (UBaseType_t x = 0; x < barrierResultCount; x++)
+    {
+        const BarrierResult_t * result = &barrierResults[ x ];
+
+        console_print("%5u %10llu %10llu %10llu %10llu %10llu\n",
+                      (unsigned) result->tasks,
+                      (unsigned long long) result->cycles,
+                      (unsigned long long) result->skewP50,
+                      (unsigned long long) result->skewP99,
+                      (unsigned long long) result->skewP999,
+                      (unsigned long long) result->skewMax);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void runLogging( ConsoleMode_t mode, BaseType_t taskBuffers )
+{
+    char taskName[ configMAX_TASK_NAME_LEN ];
+    ConsoleStats_t before, after;
+    LatencyHistogram_t total;
+
+    for (UBaseType_t x = 0; x < xDemoConfig.uxTaskCount; x++)
+    {
+        vHistogramReset(&loggingLatency[ x ]);
+    }
+
+    console_flush();
+    console_get_stats(&before);
+    console_set_mode(mode);
+    console_set_task_buffers(taskBuffers);
+    patternRunning = pdTRUE;
+    workerCount = xDemoConfig.uxTaskCount;
+
+    for (UBaseType_t x = 0; x < workerCount; x++)
+    {
+        snprintf(taskName, sizeof(taskName), "Logger%u", (unsigned) x);
+        xTaskCreate( prvLoggingTask,
+                     taskName,
+                     CONTENTION_STACK_SIZE,
+                     (void *) (uintptr_t) x,
+                     xDemoConfig.uxPriorities[ x % xDemoConfig.uxPriorityCount ],
+                     &workers[ x ] );
+    }
+
+    vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+    stopWorkers();
+
+    /* What is still in the ring is written out before the next mode, so that
+     * the runs do not pay for each other's output */
+    console_flush();
+    console_get_stats(&after);
+    console_set_mode(xDemoConfig.xConsoleMode);
+    console_set_task_buffers(pdTRUE);
+
+    vHistogramReset(&total);
+    for (UBaseType_t x = 0; x < xDemoConfig.uxTaskCount; x++)
+    {
+        vHistogramMerge(&total, &loggingLatency[ x ]);
+    }
+
+    if (loggingResultCount < MAX_LOGGING_RESULTS)
+    {
+        LoggingResult_t * result = &loggingResults[ loggingResultCount++ ];
+
+        result->mode = mode;
+        result->taskBuffers = taskBuffers;
+        result->calls = total.ullCount;
+        result->dropped = after.ulDropped - before.ulDropped;
+        result->writes = after.ulWrites - before.ulWrites;
+        result->lockWait = after.ullLockWait - before.ullLockWait;
+        result->p50 = ullHistogramPercentile(&total, 50.0);
+        result->p99 = ullHistogramPercentile(&total, 99.0);
+        result->p999 = ullHistogramPercentile(&total, 99.9);
+        result->max = total.ullMax;
+        result->mean = ullHistogramMean(&total);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void runLoggingBenchmark( void )
+{
+    /* eConsoleSync is the vprintf() under xStdioMutex every call used to
+     * pay, the others only copy into the shared ring or the task's buffer */
+    runLogging(eConsoleSync, pdFALSE);
+    runLogging(eConsoleDrop, pdFALSE);
+    runLogging(eConsoleDrop, pdTRUE);
+    runLogging(eConsoleBinary, pdTRUE);
+
+    console_print("\nCost of a console_print() call from %u task(s) - times in run time counter units (" runtimeUNIT_NAME ")\n",
+                  (unsigned) xDemoConfig.uxTaskCount);
+    console_print("%-8s %-7s %10s %10s %10s %12s %10s %10s %10s %10s %10s\n",
+                  "Mode", "Queue", "Calls", "Dropped", "Writes", "Lock wait", "p50", "p99", "p99.9", "max", "mean");
+
+    for (UBaseType_t x = 0; x < loggingResultCount; x++)
+    {
+        const LoggingResult_t * result = &loggingResults[ x ];
+
+        console_print("%-8s %-7s %10llu %10lu %10lu %12llu %10llu %10llu %10llu %10llu %10llu\n",
+                      console_mode_name(result->mode),
+                      (result->mode == eConsoleSync) ? "-" : (result->taskBuffers ? "task" : "ring"),
+                      (unsigned long long) result->calls,
+                      (unsigned long) result->dropped,
+                      (unsigned long) result->writes,
+                      (unsigned long long) result->lockWait,
+                      (unsigned long long) result->p50,
+                      (unsigned long long) result->p99,
+                      (unsigned long long) result->p999,
+                      (unsigned long long) result->max,
+                      (unsigned long long) result->mean);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSupervisorTask( void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    SemaphorePattern_t first = xDemoConfig.xPattern;
+    SemaphorePattern_t last = xDemoConfig.xPattern;
+    BackoffPolicy_t firstBackoff = xDemoConfig.xBackoff;
+    BackoffPolicy_t lastBackoff = xDemoConfig.xBackoff;
+
+    if (xDemoConfig.xPattern == ePatternAll)
+    {
+        first = ePatternNone;
+        last = ePatternSeqlock;
+    }
+
+    if (xDemoConfig.xBench == eBenchLogging)
+    {
+        runLoggingBenchmark();
+        vTaskEndScheduler();
+        vTaskDelete(NULL);
+    }
+
+    if (xDemoConfig.xBench == eBenchBarrier)
+    {
+        runBarrierBenchmark();
+        vTaskEndScheduler();
+        vTaskDelete(NULL);
+    }
+
+    if (xDemoConfig.xBench == eBenchSignal)
+    {
+        runSignalBenchmark();
+        vTaskEndScheduler();
+        vTaskDelete(NULL);
+    }
+
+    if (xDemoConfig.xBench == eBenchPublish)
+    {
+        runPublishBenchmark(first, last);
+        vTaskEndScheduler();
+        vTaskDelete(NULL);
+    }
+
+    if ((xDemoConfig.xBench == eBenchContention) || (xDemoConfig.xBench == eBenchAdaptive))
+    {
+        /* Only the patterns built around mainSemaphore can be benchmarked */
+        if (xDemoConfig.xPattern == ePatternAll)
+        {
+            first = ePatternBinary;
+            last = ePatternMutex;
+        }
+
+        runContentionBenchmark(first, last);
+        vTaskEndScheduler();
+        vTaskDelete(NULL);
+    }
+
+    if (xDemoConfig.xAllBackoffs == pdTRUE)
+    {
+        firstBackoff = eBackoffNone;
+        lastBackoff = eBackoffCount - 1;
+    }
+
+    for (BackoffPolicy_t backoff = firstBackoff; backoff <= lastBackoff; backoff++)
+    {
+        for (SemaphorePattern_t pattern = first; pattern <= last; pattern++)
+        {
+            startPattern(pattern, backoff);
+
+            /* Without a duration the demo runs as it always did - forever */
+            if (xDemoConfig.ulRunSeconds == 0)
+            {
+                vTaskDelete(NULL);
+            }
+
+            vTaskDelay((TickType_t) xDemoConfig.ulRunSeconds * configTICK_RATE_HZ);
+            stopPattern(pattern, backoff);
+        }
+    }
+
+    reportPatterns(first, last, firstBackoff, lastBackoff);
+
+    /* main_semaphores() returns once the scheduler is ended */
+    vTaskEndScheduler();
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+/* Signal readiness and wait for the other tasks to be done */
+static void rendezVousWith( UBaseType_t index )
+{
+    if (index >= rendezVousParties)
+    {
+        return;
+    }
+
+    if (xBarrierWait(&rendezVous, index, RENDEZ_VOUS_TIMEOUT))
+    {
+        console_print("\nThis is %s - Rendez-vous : we are ready!\n\n", pcTaskGetName(NULL));
+    }
+    else
+    {
+        console_print("\nThis is %s - Rendez-vous : gave up waiting\n\n", pcTaskGetName(NULL));
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void workerDone( void )
+{
+    xSemaphoreGive(workersDone);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void prvTask1(void * pvParameters )
+{
+    /* Index among the workers - the first Task1 takes part in the rendez-vous */
+    UBaseType_t index = (UBaseType_t) (uintptr_t) pvParameters;
+    
+    /* Local variables*/
+    int textLength = strlen(littleRedHatText);
+
+    /* Announce task is ready */   
+    console_print("\nThis is task 1 - launching\n" );
+
+    if (activePattern == ePatternRendezVous)
+    {
+        /* Add delay to represent some long lasting activity */
+        vTaskDelay(100 * A_100_MS_DELAY);
+        rendezVousWith(index);
+    }
+    int swapTick = 0;
+
+    vPeriodicTaskInit(&workerPeriods[ index ], TASK1_1S_PERIOD, 0);
+
+    while (patternRunning == pdTRUE)
+    {
+        /* Print out the message */
+        /* console_print( "This is task 1\n" ); */
+
+        /* Copy text & printout - let's make sure there is no overrun */
+        if (1 == swapTick )
+        {
+  
+            swapTick = 0;
+            if (activePattern == ePatternSeqlock)
+            {
+                /* Never blocks - the update is only lost if Task2 is publishing */
+                if (seqlockPublish(littleRedHatText, textLength))
+                {
+                    countUpdate();
+                }
+            }
+            else if (patternUsesMainSemaphore(activePattern))
+            {
+                /* If we can get the semaphore, we change the string */
+                if (takeMainSemaphore())
+                {
+                    slowStringCopy(&printoutText[0], littleRedHatText, textLength);
+                    countUpdate();
+                    xSemaphoreGive(mainSemaphore);
+                }
+            }
+            else
+            {
+                slowStringCopy(&printoutText[0], littleRedHatText, textLength);
+                countUpdate();
+            }
+        } else
+        {
+            swapTick++;
+        }
+        if (activePattern == ePatternSeqlock)
+        {
+            char sentence[ MAX_STRING_SIZE ];
+
+            seqlockRead(sentence);
+            console_print("The sentence is: %s \n", sentence);
+        }
+        else
+        {
+            console_print("The sentence is: %s \n", &printoutText[0]);
+        }
+        xPeriodicWaitForRelease(&workerPeriods[ index ]);
+    }
+
+    workerDone();
+}
+
+
+/*-----------------------------------------------------------*/
+
+static void prvTask2(void * pvParameters )
+{
+    /* Index among the workers - the first Task2 takes part in the rendez-vous */
+    UBaseType_t index = (UBaseType_t) (uintptr_t) pvParameters;
+    
+    /* Local variables*/
+    int textLength = strlen(dressedUpWolfText);
+
+    /* Announce task is ready */
+    console_print("\nThis is task 2 - launching\n" );
+
+    if (activePattern == ePatternRendezVous)
+    {
+        /* Add delay to represent some long lasting activity */
+        vTaskDelay(100 * A_100_MS_DELAY);    
+        rendezVousWith(index);
+    }
+
+    vPeriodicTaskInit(&workerPeriods[ index ], TASK2_2S_PERIOD, 0);
+
+    while (patternRunning == pdTRUE)
+    {
+        if (activePattern == ePatternSeqlock)
+        {
+            if (seqlockPublish(dressedUpWolfText, textLength))
+            {
+                countUpdate();
+            }
+        }
+        else if (patternUsesMainSemaphore(activePattern))
+        {
+            /* If we can get the semaphore, we change the string */
+            if (takeMainSemaphore())
+            {
+                slowStringCopy(&printoutText[0], dressedUpWolfText, textLength);
+                countUpdate();
+                /* As this task is subject to the task as far as printing is concerned  */
+                /* let's hold the semaphore a little longer for ensuring our string is  */
+                /* visible */
+                vTaskDelay(TASK2_HOLD_TIME);
+                xSemaphoreGive(mainSemaphore);
+            } 
+        }
+        else
+        {
+            slowStringCopy(&printoutText[0], dressedUpWolfText, textLength);
+            countUpdate();
+        }
+     
+        xPeriodicWaitForRelease(&workerPeriods[ index ]);
+    }
+
+    workerDone();
+}
+/*-----------------------------------------------------------*/
+
+static void prvContentionTask(void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    /* Local variables*/
+    ContentionStats_t * stats = &contentionStats[ uxTaskPriorityGet(NULL) ];
+    int textLength = strlen(littleRedHatText);
+
+    while (patternRunning == pdTRUE)
+    {
+        unsigned long start = ulGetRunTimeCounterValue();
+
+        /* Blocks until the semaphore is obtained, or the supervisor aborts
+         * the wait at the end of the run */
+        BaseType_t taken = contentionAdaptive ? xAdaptiveSemaphoreTake(&adaptiveMain, portMAX_DELAY)
+                                              : xSemaphoreTake(mainSemaphore, portMAX_DELAY);
+        if (taken)
+        {
+            unsigned long obtained = ulGetRunTimeCounterValue();
+
+            slowStringCopy(&printoutText[0], littleRedHatText, textLength);
+
+            unsigned long released = ulGetRunTimeCounterValue();
+            if (contentionAdaptive) xAdaptiveSemaphoreGive(&adaptiveMain);
+            else xSemaphoreGive(mainSemaphore);
+
+            taskENTER_CRITICAL();
+            {
+                vHistogramRecord(&stats->wait, obtained - start);
+                vHistogramRecord(&stats->hold, released - obtained);
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /* Let the tasks of the same priority compete for the next take */
+        taskYIELD();
+    }
+
+    workerDone();
+}
+/*-----------------------------------------------------------*/
+
+static void prvPublishWriterTask(void * pvParameters )
+{
+    /* Writers alternate between the two texts */
+    char * text = ((uintptr_t) pvParameters % 2) ? littleRedHatText : dressedUpWolfText;
+    int textLength = strlen(text);
+    PublishStats_t * stats = &publishStats[ activePattern ];
+    BaseType_t published;
+
+    while (patternRunning == pdTRUE)
+    {
+        if (activePattern == ePatternSeqlock)
+        {
+            published = seqlockPublish(text, textLength);
+        }
+        else if (patternUsesMainSemaphore(activePattern))
+        {
+            /* Same rule as Task1: no waiting, the update is dropped instead */
+            published = xSemaphoreTake(mainSemaphore, ( TickType_t ) 0);
+            if (published)
+            {
+                slowStringCopy(&printoutText[0], text, textLength);
+                xSemaphoreGive(mainSemaphore);
+            }
+        }
+        else
+        {
+            slowStringCopy(&printoutText[0], text, textLength);
+            published = pdTRUE;
+        }
+
+        taskENTER_CRITICAL();
+        if (published) stats->published++; else stats->skipped++;
+        taskEXIT_CRITICAL();
+
+        vTaskDelay(1);
+    }
+
+    workerDone();
+}
+/*-----------------------------------------------------------*/
+
+static void prvPublishReaderTask(void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    PublishStats_t * stats = &publishStats[ activePattern ];
+    char sentence[ MAX_STRING_SIZE ];
+    uint32_t retries = 0;
+    BaseType_t consistent;
+
+    while (patternRunning == pdTRUE)
+    {
+        unsigned long start = ulGetRunTimeCounterValue();
+
+        if (activePattern == ePatternSeqlock)
+        {
+            retries = seqlockRead(sentence);
+            consistent = pdTRUE;
+        }
+        else if (patternUsesMainSemaphore(activePattern))
+        {
+            /* The reader has to see the text, so it waits for the writers */
+            consistent = xSemaphoreTake(mainSemaphore, portMAX_DELAY);
+            memcpy(sentence, printoutText, MAX_STRING_SIZE);
+            if (consistent) xSemaphoreGive(mainSemaphore);
+        }
+        else
+        {
+            memcpy(sentence, printoutText, MAX_STRING_SIZE);
+            consistent = pdTRUE;
+        }
+
+        unsigned long latency = ulGetRunTimeCounterValue() - start;
+
+        /* A wait aborted by the supervisor does not count as a read */
+        if (consistent)
+        {
+            sentence[ MAX_STRING_SIZE - 1 ] = '\0';
+
+            taskENTER_CRITICAL();
+            {
+                stats->reads++;
+                stats->retries += retries;
+                if (!isWholeText(sentence)) stats->torn++;
+                vHistogramRecord(&stats->readLatency, latency);
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        vTaskDelay(1);
+    }
+
+    workerDone();
+}
+/*-----------------------------------------------------------*/
+
+static void prvSignallerTask(void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    while (patternRunning == pdTRUE)
+    {
+        vTaskDelay(1);
+
+        signalGivenAt = ulGetRunTimeCounterValue();
+        if (benchUsesNotify) xNotifySignalGive(&benchNotifySignal);
+        else xSemaphoreSignalGive(&benchSemaphoreSignal);
+    }
+
+    workerDone();
+}
+/*-----------------------------------------------------------*/
+
+static void prvSignalWaiterTask(void * pvParameters )
+{
+    /* Prevent the compiler warning about the unused parameter. */
+    ( void ) pvParameters;
+
+    LatencyHistogram_t * latency = &signalLatency[ benchUsesNotify ];
+    BaseType_t woken;
+
+    while (patternRunning == pdTRUE)
+    {
+        /* The supervisor aborts the wait at the end of the run */
+        if (benchUsesNotify) woken = xNotifySignalTake(&benchNotifySignal, portMAX_DELAY);
+        else woken = xSemaphoreSignalTake(&benchSemaphoreSignal, portMAX_DELAY);
+
+        if (woken)
+        {
+            /* Only this task records into the histogram */
+            vHistogramRecord(latency, ulGetRunTimeCounterValue() - signalGivenAt);
+        }
+    }
+
+    workerDone();
+}
+/*-----------------------------------------------------------*/
+
+static void prvBarrierTask(void * pvParameters )
+{
+    UBaseType_t party = (UBaseType_t) (uintptr_t) pvParameters;
+
+    while (patternRunning == pdTRUE)
+    {
+        vWorkBurnUs(xDemoConfig.ulCriticalSectionLength);
+
+        /* The supervisor aborts the wait at the end of the run, which only
+         * reaches the parties blocked on the barrier by then */
+        if (xBarrierWait(&benchBarrier, party, barrierWaitTimeout))
+        {
+            unsigned long released = ulGetRunTimeCounterValue();
+
+            /* No task can reach the next cycle before all of them have been
+             * released, and counted, in this one */
+            taskENTER_CRITICAL();
+            {
+                /* Tasks can be preempted between reading the time and
+                 * getting here, so the order of arrival is not trusted */
+                if ((cycleReleases == 0) || (released < cycleFirstRelease))
+                {
+                    cycleFirstRelease = released;
+                }
+
+                if ((cycleReleases == 0) || (released > cycleLastRelease))
+                {
+                    cycleLastRelease = released;
+                }
+
+                if (++cycleReleases == benchBarrier.uxParties)
+                {
+                    vHistogramRecord(&releaseSkew, cycleLastRelease - cycleFirstRelease);
+                    cycleReleases = 0;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    workerDone();
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingTask(void * pvParameters )
+{
+    UBaseType_t index = (UBaseType_t) (uintptr_t) pvParameters;
+    LatencyHistogram_t * latency = &loggingLatency[ index ];
+    uint32_t sequence = 0;
+
+    while (patternRunning == pdTRUE)
+    {
+        for (int x = 0; x < LOGGING_CALLS_PER_TICK; x++)
+        {
+            unsigned long start = ulGetRunTimeCounterValue();
+
+            /* A typical trace line: a string, a couple of integers */
+            console_print("%s: update %lu of \"%s\" took %u ticks\n",
+                          pcTaskGetName(NULL), (unsigned long) sequence++, anInitialText, (unsigned) x);
+            vHistogramRecord(latency, ulGetRunTimeCounterValue() - start);
+        }
+
+        vTaskDelay(1);
+    }
+
+    workerDone();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,127 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Persistent log in a memory mapped file - see mmap_log.h.
+*----------------------------------------------------------*/
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "mmap_log.h"
+
+/*-----------------------------------------------------------*/
+
+int iMmapLogOpen( MmapLog_t * pxLog,
+                  const char * pcPath,
+                  size_t xCapacity )
+{
+    size_t xMapped = mmaplogDATA_OFFSET + xCapacity;
+    void * pvMapped;
+    int iFd;
+
+    pxLog->pxHeader = NULL;
+
+    iFd = open( pcPath, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+
+    if( iFd < 0 )
+    {
+        return -1;
+    }
+
+    /* The file is all zeros, as are the cursors of an empty log. */
+    if( ftruncate( iFd, ( off_t ) xMapped ) != 0 )
+    {
+        close( iFd );
+        return -1;
+    }
+
+    pvMapped = mmap( NULL, xMapped, PROT_READ | PROT_WRITE, MAP_SHARED, iFd, 0 );
+
+    /* The mapping keeps the file open. */
+    close( iFd );
+
+    if( pvMapped == MAP_FAILED )
+    {
+        return -1;
+    }
+
+    pxLog->pxHeader = pvMapped;
+    pxLog->pucData = ( uint8_t * ) pvMapped + mmaplogDATA_OFFSET;
+    pxLog->xMapped = xMapped;
+
+    pxLog->pxHeader->ulVersion = mmaplogVERSION;
+    pxLog->pxHeader->ulDataOffset = mmaplogDATA_OFFSET;
+    pxLog->pxHeader->ullCapacity = xCapacity;
+
+    /* Written last: a reader only trusts a header with the magic. */
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    memcpy( pxLog->pxHeader->cMagic, mmaplogMAGIC, mmaplogMAGIC_LENGTH );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vMmapLogWrite( MmapLog_t * pxLog,
+                    const void * pvData,
+                    size_t xLength )
+{
+    MmapLogHeader_t * pxHeader = pxLog->pxHeader;
+    const uint8_t * pucData = pvData;
+    uint64_t ullCapacity = pxHeader->ullCapacity;
+    uint64_t ullPosition = pxHeader->ullCommitted;
+
+    /* Older bytes would only be overwritten by the end of the same write. */
+    if( xLength > ullCapacity )
+    {
+        ullPosition += xLength - ullCapacity;
+        pucData += xLength - ullCapacity;
+        xLength = ( size_t ) ullCapacity;
+    }
+
+    __atomic_store_n( &pxHeader->ullReserved, ullPosition + xLength, __ATOMIC_RELEASE );
+
+    size_t xOffset = ( size_t ) ( ullPosition % ullCapacity );
+    size_t xFirst = ( xLength < ullCapacity - xOffset ) ? xLength : ( size_t ) ( ullCapacity - xOffset );
+
+    memcpy( &pxLog->pucData[ xOffset ], pucData, xFirst );
+    memcpy( pxLog->pucData, pucData + xFirst, xLength - xFirst );
+
+    __atomic_store_n( &pxHeader->ullCommitted, ullPosition + xLength, __ATOMIC_RELEASE );
+}
+/*-----------------------------------------------------------*/
+
+void vMmapLogClose( MmapLog_t * pxLog )
+{
+    if( pxLog->pxHeader != NULL )
+    {
+        munmap( pxLog->pxHeader, pxLog->xMapped );
+        pxLog->pxHeader = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,98 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef MMAP_LOG_H
+    #define MMAP_LOG_H
+
+    #include <stddef.h>
+    #include <stdint.h>
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Persistent log in a memory mapped file.
+*
+* The file is a header followed by a ring of ullCapacity bytes, mapped
+* shared, so that writing to the log is a memcpy() - no system call - and
+* what was written survives the process however it ends: the pages belong to
+* the page cache, not to the process.
+*
+* The cursors count the bytes written since the file was created, the ring
+* holding the last ullCapacity of them.  A write first moves ullReserved past
+* the bytes it is about to overwrite, copies them, then moves ullCommitted:
+* the bytes from ullReserved - ullCapacity up to ullCommitted are intact even
+* if the process died in the middle of a write.  Only one task writes at a
+* time - the console writes under xStdioMutex.  tools/log_reader.c extracts
+* the log, in order.
+*----------------------------------------------------------*/
+
+    #define mmaplogMAGIC           "FRTMLOG1"
+    #define mmaplogMAGIC_LENGTH    ( 8U )
+    #define mmaplogVERSION         ( 1U )
+
+/* The ring starts at this offset in the file. */
+    #define mmaplogDATA_OFFSET     ( 64U )
+
+    typedef struct MmapLogHeader
+    {
+        char cMagic[ mmaplogMAGIC_LENGTH ];
+        uint32_t ulVersion;
+        uint32_t ulDataOffset;
+        uint64_t ullCapacity;
+        uint64_t ullReserved;
+        uint64_t ullCommitted;
+    } MmapLogHeader_t;
+
+    typedef struct MmapLog
+    {
+        MmapLogHeader_t * pxHeader; /* NULL while not open. */
+        uint8_t * pucData;
+        size_t xMapped;
+    } MmapLog_t;
+
+/*
+ * Creates - or truncates - pcPath with a ring of xCapacity bytes and maps it.
+ * Returns 0 on success, -1 with errno set otherwise.
+ */
+    int iMmapLogOpen( MmapLog_t * pxLog,
+                      const char * pcPath,
+                      size_t xCapacity );
+
+/* Appends xLength bytes, of which only the last ullCapacity are kept. */
+    void vMmapLogWrite( MmapLog_t * pxLog,
+                        const void * pvData,
+                        size_t xLength );
+
+/* Unmaps the file, which keeps the log. */
+    void vMmapLogClose( MmapLog_t * pxLog );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* MMAP_LOG_H */
@@ -0,0 +1,127 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Drift-free periodic jobs - see periodic_task.h.
+*----------------------------------------------------------*/
+
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "periodic_task.h"
+#include "console.h"
+#include "run_time_stats.h"
+
+/* The tick interrupt and the run time counter both follow the monotonic
+ * clock of the host, so a tick is runtimeCOUNTS_PER_TICK counts. */
+
+/*-----------------------------------------------------------*/
+
+void vPeriodicTaskInit( PeriodicTask_t * pxPeriodic,
+                        TickType_t xPeriod,
+                        TickType_t xDeadline )
+{
+    memset( pxPeriodic, 0, sizeof( *pxPeriodic ) );
+    vHistogramReset( &pxPeriodic->xJitter );
+    vHistogramReset( &pxPeriodic->xResponse );
+
+    pxPeriodic->xPeriod = xPeriod;
+    pxPeriodic->ulDeadline = ( unsigned long ) ( ( xDeadline != 0 ) ? xDeadline : xPeriod ) * runtimeCOUNTS_PER_TICK;
+
+    /* Start on a tick so that the reference is as close as possible to the
+     * time xTaskDelayUntil() counts the releases from. */
+    vTaskDelay( 1 );
+    pxPeriodic->xFirstWakeTime = xTaskGetTickCount();
+    pxPeriodic->xLastWakeTime = pxPeriodic->xFirstWakeTime;
+    pxPeriodic->ulFirstRelease = ulGetRunTimeCounterValue();
+    pxPeriodic->ulRelease = pxPeriodic->ulFirstRelease;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPeriodicWaitForRelease( PeriodicTask_t * pxPeriodic )
+{
+    unsigned long ulResponse = ulGetRunTimeCounterValue() - pxPeriodic->ulRelease;
+    BaseType_t xDeadlineMet = ( ulResponse <= pxPeriodic->ulDeadline ) ? pdTRUE : pdFALSE;
+    unsigned long ulStart;
+
+    pxPeriodic->ulJobs++;
+    vHistogramRecord( &pxPeriodic->xResponse, ulResponse );
+
+    if( xDeadlineMet == pdFALSE )
+    {
+        pxPeriodic->ulOverruns++;
+    }
+
+    /* Returns without blocking when the release is already past. */
+    if( xTaskDelayUntil( &pxPeriodic->xLastWakeTime, pxPeriodic->xPeriod ) == pdFALSE )
+    {
+        pxPeriodic->ulLateReleases++;
+    }
+
+    ulStart = ulGetRunTimeCounterValue();
+    pxPeriodic->ulRelease = pxPeriodic->ulFirstRelease +
+                            ( unsigned long ) ( pxPeriodic->xLastWakeTime - pxPeriodic->xFirstWakeTime ) * runtimeCOUNTS_PER_TICK;
+
+    /* The reference itself may have been taken a little late. */
+    vHistogramRecord( &pxPeriodic->xJitter, ( ulStart > pxPeriodic->ulRelease ) ? ulStart - pxPeriodic->ulRelease : 0 );
+
+    return xDeadlineMet;
+}
+/*-----------------------------------------------------------*/
+
+void vPeriodicTaskReport( const char * const pcNames[],
+                          const PeriodicTask_t * const pxPeriodics[],
+                          UBaseType_t uxCount )
+{
+    console_print( "%-12s %9s %7s %9s %6s %10s %10s %10s %10s %10s %10s\n",
+                   "Task", "Period ms", "Jobs", "Overruns", "Late",
+                   "Jitter p50", "p99", "max", "Resp p50", "p99", "max" );
+
+    for( UBaseType_t x = 0; x < uxCount; x++ )
+    {
+        const PeriodicTask_t * pxPeriodic = pxPeriodics[ x ];
+
+        console_print( "%-12s %9lu %7lu %9lu %6lu %10llu %10llu %10llu %10llu %10llu %10llu\n",
+                       pcNames[ x ],
+                       ( unsigned long ) pxPeriodic->xPeriod * 1000UL / configTICK_RATE_HZ,
+                       ( unsigned long ) pxPeriodic->ulJobs,
+                       ( unsigned long ) pxPeriodic->ulOverruns,
+                       ( unsigned long ) pxPeriodic->ulLateReleases,
+                       ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxPeriodic->xJitter, 50.0 ) ),
+                       ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxPeriodic->xJitter, 99.0 ) ),
+                       ( unsigned long long ) runtimeCOUNTS_TO_US( pxPeriodic->xJitter.ullMax ),
+                       ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxPeriodic->xResponse, 50.0 ) ),
+                       ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxPeriodic->xResponse, 99.0 ) ),
+                       ( unsigned long long ) runtimeCOUNTS_TO_US( pxPeriodic->xResponse.ullMax ) );
+    }
+
+    console_print( "(jitter and response times in us)\n" );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,101 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef PERIODIC_TASK_H
+    #define PERIODIC_TASK_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+    #include "task.h"
+
+    #include "latency_histogram.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Drift-free periodic jobs with release jitter, response time and overrun
+* measurement.
+*
+* A periodic task calls xPeriodicWaitForRelease() in place of vTaskDelay() at
+* the end of each job.  The next release is computed by xTaskDelayUntil() from
+* the previous one, so the period does not drift by the execution time of the
+* job.  For each job, the time between its nominal release and the moment it
+* starts running (release jitter), and between its nominal release and its
+* end (response time), are recorded.  A job whose response time exceeds the
+* deadline is an overrun; a release already past by the end of the previous
+* job is counted as late and starts straight away.
+*
+* The nominal releases are counted from the first one, aligned on a tick,
+* which is taken as the time reference.  Times are in run time counter units - see
+* ulGetRunTimeCounterValue().  Only the periodic task itself updates its
+* statistics, read them once it is stopped.
+*----------------------------------------------------------*/
+
+    typedef struct PeriodicTask
+    {
+        TickType_t xPeriod;
+        unsigned long ulDeadline;       /* Relative to the release. */
+        TickType_t xFirstWakeTime;
+        TickType_t xLastWakeTime;       /* Maintained by xTaskDelayUntil(). */
+        unsigned long ulFirstRelease;   /* Time reference of the nominal releases. */
+        unsigned long ulRelease;        /* Nominal release of the current job. */
+
+        /* Statistics. */
+        uint32_t ulJobs;                /* Completed jobs. */
+        uint32_t ulOverruns;            /* ... that ended past their deadline. */
+        uint32_t ulLateReleases;        /* Releases already past when the previous job ended. */
+        LatencyHistogram_t xJitter;
+        LatencyHistogram_t xResponse;
+    } PeriodicTask_t;
+
+/*
+ * xDeadline is relative to each release, 0 makes it the period.  Call it
+ * from the periodic task - it waits for the next tick, which releases the
+ * first job.
+ */
+    void vPeriodicTaskInit( PeriodicTask_t * pxPeriodic,
+                            TickType_t xPeriod,
+                            TickType_t xDeadline );
+
+/*
+ * Ends the current job and blocks until the release of the next one.
+ * Returns pdFALSE if the job that just ended overran its deadline.
+ */
+    BaseType_t xPeriodicWaitForRelease( PeriodicTask_t * pxPeriodic );
+
+/* Prints one line per task with console_print(), after a header line. */
+    void vPeriodicTaskReport( const char * const pcNames[],
+                              const PeriodicTask_t * const pxPeriodics[],
+                              UBaseType_t uxCount );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* PERIODIC_TASK_H */
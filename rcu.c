@@ -0,0 +1,223 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Read-copy-update publication - see rcu.h.
+*----------------------------------------------------------*/
+
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "rcu.h"
+
+/* Reclaimed by the idle task. */
+static RcuDomain_t * volatile pxIdleDomain = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vRcuInit( RcuDomain_t * pxDomain,
+               UBaseType_t uxReaderCount,
+               void ( * vFree )( void * pvVersion ) )
+{
+    configASSERT( ( uxReaderCount > 0 ) && ( uxReaderCount <= rcuMAX_READERS ) );
+
+    memset( pxDomain, 0, sizeof( *pxDomain ) );
+    pxDomain->uxReaderCount = uxReaderCount;
+    pxDomain->ulEpoch = 1U;
+    pxDomain->vFree = vFree;
+}
+/*-----------------------------------------------------------*/
+
+void vRcuDelete( RcuDomain_t * pxDomain )
+{
+    if( pxIdleDomain == pxDomain )
+    {
+        vRcuReclaimFromIdle( NULL );
+    }
+
+    while( pxDomain->uxRetiredCount > 0 )
+    {
+        pxDomain->vFree( pxDomain->xRetired[ pxDomain->uxRetiredHead ].pvVersion );
+        pxDomain->uxRetiredHead = ( pxDomain->uxRetiredHead + 1U ) % rcuMAX_RETIRED;
+        pxDomain->uxRetiredCount--;
+        pxDomain->ulReclaimed++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vRcuReadLock( RcuDomain_t * pxDomain,
+                   UBaseType_t uxReader )
+{
+    /* The shared pointer is only loaded after the slot is set, so a version
+     * replaced before an old epoch was stored here is never seen. */
+    __atomic_store_n( &pxDomain->xSlots[ uxReader ].ulEpoch,
+                      __atomic_load_n( &pxDomain->ulEpoch, __ATOMIC_SEQ_CST ),
+                      __ATOMIC_SEQ_CST );
+}
+/*-----------------------------------------------------------*/
+
+void vRcuReadUnlock( RcuDomain_t * pxDomain,
+                     UBaseType_t uxReader )
+{
+    /* The quiescent point. */
+    __atomic_store_n( &pxDomain->xSlots[ uxReader ].ulEpoch, 0U, __ATOMIC_RELEASE );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRetire( RcuDomain_t * pxDomain,
+                             void * pvVersion,
+                             uint32_t ulEpoch )
+{
+    BaseType_t xRetired = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxDomain->uxRetiredCount < rcuMAX_RETIRED )
+        {
+            RcuRetired_t * pxRetired = &pxDomain->xRetired[ ( pxDomain->uxRetiredHead + pxDomain->uxRetiredCount ) % rcuMAX_RETIRED ];
+
+            pxRetired->pvVersion = pvVersion;
+            pxRetired->ulEpoch = ulEpoch;
+            pxDomain->uxRetiredCount++;
+            pxDomain->ulRetired++;
+
+            if( pxDomain->uxRetiredCount > pxDomain->uxMaxRetired )
+            {
+                pxDomain->uxMaxRetired = pxDomain->uxRetiredCount;
+            }
+
+            xRetired = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xRetired;
+}
+/*-----------------------------------------------------------*/
+
+void vRcuPublish( RcuDomain_t * pxDomain,
+                  void ** ppvShared,
+                  void * pvVersion )
+{
+    void * pvOld = __atomic_exchange_n( ppvShared, pvVersion, __ATOMIC_SEQ_CST );
+
+    /* Read sections starting from this epoch on can only see pvVersion. */
+    uint32_t ulEpoch = __atomic_add_fetch( &pxDomain->ulEpoch, 1U, __ATOMIC_SEQ_CST );
+
+    pxDomain->ulPublished++;
+
+    if( pvOld == NULL )
+    {
+        return;
+    }
+
+    if( prvRetire( pxDomain, pvOld, ulEpoch ) == pdFALSE )
+    {
+        pxDomain->ulPublishStalls++;
+
+        while( prvRetire( pxDomain, pvOld, ulEpoch ) == pdFALSE )
+        {
+            if( uxRcuReclaim( pxDomain ) == 0 )
+            {
+                vTaskDelay( 1 );
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxRcuReclaim( RcuDomain_t * pxDomain )
+{
+    void * pvFreed[ rcuMAX_RETIRED ];
+    UBaseType_t uxFreed = 0;
+    uint32_t ulOldest = UINT32_MAX;
+    uint32_t ulRetired;
+
+    /* Only the versions retired before the scan below are considered: a
+     * reader of one of them has set its slot before the version was
+     * replaced, so the scan cannot miss it. */
+    taskENTER_CRITICAL();
+    ulRetired = pxDomain->ulRetired;
+    taskEXIT_CRITICAL();
+
+    /* The oldest read section still running - a reader starting from now on
+     * gets a newer epoch. */
+    for( UBaseType_t x = 0; x < pxDomain->uxReaderCount; x++ )
+    {
+        uint32_t ulEpoch = __atomic_load_n( &pxDomain->xSlots[ x ].ulEpoch, __ATOMIC_SEQ_CST );
+
+        if( ( ulEpoch != 0U ) && ( ulEpoch < ulOldest ) )
+        {
+            ulOldest = ulEpoch;
+        }
+    }
+
+    /* Versions are retired in epoch order. */
+    taskENTER_CRITICAL();
+    {
+        while( ( pxDomain->uxRetiredCount > 0 ) &&
+               ( pxDomain->ulReclaimed + uxFreed != ulRetired ) &&
+               ( pxDomain->xRetired[ pxDomain->uxRetiredHead ].ulEpoch <= ulOldest ) )
+        {
+            pvFreed[ uxFreed++ ] = pxDomain->xRetired[ pxDomain->uxRetiredHead ].pvVersion;
+            pxDomain->uxRetiredHead = ( pxDomain->uxRetiredHead + 1U ) % rcuMAX_RETIRED;
+            pxDomain->uxRetiredCount--;
+        }
+
+        pxDomain->ulReclaimed += uxFreed;
+    }
+    taskEXIT_CRITICAL();
+
+    /* Outside of the critical section, the heap has its own locking. */
+    for( UBaseType_t x = 0; x < uxFreed; x++ )
+    {
+        pxDomain->vFree( pvFreed[ x ] );
+    }
+
+    return uxFreed;
+}
+/*-----------------------------------------------------------*/
+
+void vRcuReclaimFromIdle( RcuDomain_t * pxDomain )
+{
+    pxIdleDomain = pxDomain;
+}
+/*-----------------------------------------------------------*/
+
+void vRcuIdleHook( void )
+{
+    RcuDomain_t * pxDomain = pxIdleDomain;
+
+    if( pxDomain != NULL )
+    {
+        ( void ) uxRcuReclaim( pxDomain );
+    }
+}
+/*-----------------------------------------------------------*/
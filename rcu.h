@@ -0,0 +1,135 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef RCU_H
+    #define RCU_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+    #include "task.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Read-copy-update publication of a shared pointer.
+*
+* Readers never wait: between vRcuReadLock() and vRcuReadUnlock() they load
+* the shared pointer with pvRcuDereference() and use what it points to.  An
+* updater builds a new version, and vRcuPublish() swaps it in and retires
+* the old one.  A retired version is only freed once every reader has passed
+* a quiescent point - left the read section it was in when the version was
+* replaced - which uxRcuReclaim() checks without blocking anybody.
+*
+* Each reader task has a slot of its own, read sections do not nest, and
+* updaters of the same pointer must be serialised by the caller.
+* uxRcuReclaim() is called by updaters when too many versions are pending,
+* and should be called regularly besides: by a grace-period task, or by the
+* idle task through vRcuIdleHook() for the domain registered with
+* vRcuReclaimFromIdle() - as long as the idle task gets to run.
+*----------------------------------------------------------*/
+
+    #ifndef rcuMAX_READERS
+        #define rcuMAX_READERS    ( 1024U )
+    #endif
+
+/* Versions retired but not yet freed - vRcuPublish() waits beyond that. */
+    #ifndef rcuMAX_RETIRED
+        #define rcuMAX_RETIRED    ( 32U )
+    #endif
+
+/* Slots are kept on cache lines of their own. */
+    #define rcuSLOT_SIZE          ( 64U )
+
+    typedef struct RcuReaderSlot
+    {
+        uint32_t ulEpoch; /* Epoch the read section started in, 0 outside. */
+        uint8_t ucPadding[ rcuSLOT_SIZE - sizeof( uint32_t ) ];
+    } __attribute__( ( aligned( rcuSLOT_SIZE ) ) ) RcuReaderSlot_t;
+
+    typedef struct RcuRetired
+    {
+        void * pvVersion;
+        uint32_t ulEpoch; /* Freed once no reader started before it. */
+    } RcuRetired_t;
+
+    typedef struct RcuDomain
+    {
+        RcuReaderSlot_t xSlots[ rcuMAX_READERS ];
+        UBaseType_t uxReaderCount;
+        uint32_t ulEpoch;
+        void ( * vFree )( void * pvVersion );
+
+        /* Ring of retired versions, in critical sections. */
+        RcuRetired_t xRetired[ rcuMAX_RETIRED ];
+        UBaseType_t uxRetiredHead;
+        UBaseType_t uxRetiredCount;
+
+        /* Statistics, not reset by the domain. */
+        uint32_t ulPublished;
+        uint32_t ulRetired;
+        uint32_t ulReclaimed;
+        uint32_t ulPublishStalls;    /* vRcuPublish() calls that waited for reclamation. */
+        UBaseType_t uxMaxRetired;
+    } RcuDomain_t;
+
+    void vRcuInit( RcuDomain_t * pxDomain,
+                   UBaseType_t uxReaderCount,
+                   void ( * vFree )( void * pvVersion ) );
+
+/* Frees all the retired versions - no reader may be left. */
+    void vRcuDelete( RcuDomain_t * pxDomain );
+
+    void vRcuReadLock( RcuDomain_t * pxDomain,
+                       UBaseType_t uxReader );
+    void vRcuReadUnlock( RcuDomain_t * pxDomain,
+                         UBaseType_t uxReader );
+
+    #define pvRcuDereference( ppvShared )    __atomic_load_n( ( ppvShared ), __ATOMIC_SEQ_CST )
+
+/*
+ * Makes pvVersion the version of *ppvShared seen by new read sections, and
+ * retires the previous one.  Waits, a tick at a time, if rcuMAX_RETIRED
+ * versions are still pending.
+ */
+    void vRcuPublish( RcuDomain_t * pxDomain,
+                      void ** ppvShared,
+                      void * pvVersion );
+
+/* Frees the versions no reader can see any more, returns how many. */
+    UBaseType_t uxRcuReclaim( RcuDomain_t * pxDomain );
+
+/* The domain reclaimed by vRcuIdleHook(), NULL for none. */
+    void vRcuReclaimFromIdle( RcuDomain_t * pxDomain );
+    void vRcuIdleHook( void );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* RCU_H */
@@ -32,8 +32,8 @@
  * real time, therefore the run time counter values have no real meaningful
  * units.
  *
- * Also note that it is assumed this demo is going to be used for short periods
- * of time only, and therefore timer overflows are not handled.
+ * The counter is kept on 64 bits, in the resolution chosen at build time, and
+ * read from the TSC where it can be - see run_time_stats.h.
  */
 
 #include <time.h>
@@ -41,27 +41,266 @@
 /* FreeRTOS includes. */
 #include <FreeRTOS.h>
 
+#include "run_time_stats.h"
+
+#ifndef projRUN_TIME_TSC
+    #define projRUN_TIME_TSC    1
+#endif
+
+#if ( projRUN_TIME_TSC == 1 ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+    #include <cpuid.h>
+    #include <x86intrin.h>
+    #define runtimeHAS_TSC    1
+#else
+    #define runtimeHAS_TSC    0
+#endif
+
+/* The TSC rate is first measured over runtimeCALIBRATION_NS, then the
+ * conversion is corrected every runtimeANCHOR_PERIOD_NS. */
+#define runtimeCALIBRATION_NS      ( 10ULL * 1000000ULL )
+#define runtimeANCHOR_PERIOD_NS    ( 1000000000ULL )
+
 /* Time at start of day (in ns). */
-static unsigned long ulStartTimeNs;
+static uint64_t ullStartTimeNs;
+
+#if ( runtimeHAS_TSC == 1 )
+
+/* From TSC to ns since the start: ullNsBase + ( ( tsc - ullTscBase ) *
+ * ullMult ) >> 32, until ullNextAnchor.  Written under ulSequence (a seqlock),
+ * by the one reader that finds the anchor is due. */
+    typedef struct TscClock
+    {
+        uint32_t ulSequence;
+        uint64_t ullTscBase;
+        uint64_t ullNsBase;
+        uint64_t ullMult; /* ns per TSC cycle, 32.32 fixed point. */
+        uint64_t ullNextAnchor;
+    } TscClock_t;
+
+    static TscClock_t xTsc;
+    static BaseType_t xUseTsc = pdFALSE;
+    static uint32_t ulAnchoring = 0;
+
+/* Reference point of the rate: the end of the calibration. */
+    static uint64_t ullCalibrationTsc;
+    static uint64_t ullCalibrationNs;
+
+#endif /* runtimeHAS_TSC */
 
 /*-----------------------------------------------------------*/
 
-void vConfigureTimerForRunTimeStats( void )
+static uint64_t prvMonotonicNs( void )
 {
     struct timespec xNow;
 
     clock_gettime( CLOCK_MONOTONIC, &xNow );
-    ulStartTimeNs = xNow.tv_sec * 1000000000ul + xNow.tv_nsec;
+
+    return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+#if ( runtimeHAS_TSC == 1 )
+
+/* Only a TSC that ticks at a constant rate in all power states, and keeps
+ * going in deep sleep, can stand in for CLOCK_MONOTONIC. */
+    static BaseType_t prvHasInvariantTsc( void )
+    {
+        unsigned int uiEax, uiEbx, uiEcx, uiEdx;
+
+        if( ( __get_cpuid( 0x80000000U, &uiEax, &uiEbx, &uiEcx, &uiEdx ) == 0 ) || ( uiEax < 0x80000007U ) )
+        {
+            return pdFALSE;
+        }
+
+        __get_cpuid( 0x80000007U, &uiEax, &uiEbx, &uiEcx, &uiEdx );
+
+        return ( uiEdx & ( 1U << 8 ) ) ? pdTRUE : pdFALSE;
+    }
+/*-----------------------------------------------------------*/
+
+    static uint64_t prvTscToNs( uint64_t ullTsc,
+                                uint64_t ullTscBase,
+                                uint64_t ullNsBase,
+                                uint64_t ullMult )
+    {
+        /* A thread on another core may read a TSC a little behind the one
+         * the anchor was taken from. */
+        if( ullTsc <= ullTscBase )
+        {
+            return ullNsBase;
+        }
+
+        return ullNsBase + ( uint64_t ) ( ( ( unsigned __int128 ) ( ullTsc - ullTscBase ) * ullMult ) >> 32 );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvWriteTscClock( uint64_t ullTscBase,
+                                  uint64_t ullNsBase,
+                                  uint64_t ullMult,
+                                  uint64_t ullNextAnchor )
+    {
+        __atomic_store_n( &xTsc.ulSequence, xTsc.ulSequence + 1U, __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_RELEASE );
+        __atomic_store_n( &xTsc.ullTscBase, ullTscBase, __ATOMIC_RELAXED );
+        __atomic_store_n( &xTsc.ullNsBase, ullNsBase, __ATOMIC_RELAXED );
+        __atomic_store_n( &xTsc.ullMult, ullMult, __ATOMIC_RELAXED );
+        __atomic_store_n( &xTsc.ullNextAnchor, ullNextAnchor, __ATOMIC_RELAXED );
+        __atomic_store_n( &xTsc.ulSequence, xTsc.ulSequence + 1U, __ATOMIC_RELEASE );
+    }
+/*-----------------------------------------------------------*/
+
+/* Measures the TSC rate against CLOCK_MONOTONIC, by spinning - the scheduler
+ * has not started, nothing else runs. */
+    static void prvCalibrateTsc( void )
+    {
+        uint64_t ullTsc0 = __rdtsc();
+        uint64_t ullNs0 = prvMonotonicNs();
+        uint64_t ullTsc1, ullNs1;
+
+        do
+        {
+            ullTsc1 = __rdtsc();
+            ullNs1 = prvMonotonicNs();
+        } while( ullNs1 - ullNs0 < runtimeCALIBRATION_NS );
+
+        if( ullTsc1 <= ullTsc0 )
+        {
+            return;
+        }
+
+        ullCalibrationTsc = ullTsc1;
+        ullCalibrationNs = ullNs1 - ullStartTimeNs;
+
+        uint64_t ullMult = ( uint64_t ) ( ( ( unsigned __int128 ) ( ullNs1 - ullNs0 ) << 32 ) / ( ullTsc1 - ullTsc0 ) );
+        uint64_t ullPeriod = ( uint64_t ) ( ( ( unsigned __int128 ) runtimeANCHOR_PERIOD_NS << 32 ) / ullMult );
+
+        prvWriteTscClock( ullCalibrationTsc, ullCalibrationNs, ullMult, ullCalibrationTsc + ullPeriod );
+        xUseTsc = pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+/* Re-measures the rate since the calibration, and sets the slope for the
+ * next period so that the counter, starting from where it is, meets
+ * CLOCK_MONOTONIC again at its end.  The counter never jumps. */
+    static void prvAnchorTsc( void )
+    {
+        if( __atomic_exchange_n( &ulAnchoring, 1U, __ATOMIC_ACQUIRE ) != 0U )
+        {
+            return;
+        }
+
+        /* Only written here, so read without the seqlock - another reader
+         * may have moved the anchor since this one found it due. */
+        uint64_t ullTsc = __rdtsc();
+        uint64_t ullTrueNs = prvMonotonicNs() - ullStartTimeNs;
+
+        if( ullTsc < xTsc.ullNextAnchor )
+        {
+            __atomic_store_n( &ulAnchoring, 0U, __ATOMIC_RELEASE );
+            return;
+        }
+
+        uint64_t ullNs = prvTscToNs( ullTsc, xTsc.ullTscBase, xTsc.ullNsBase, xTsc.ullMult );
+        __int128 xRate = ( __int128 ) ( ( ( unsigned __int128 ) ( ullTrueNs - ullCalibrationNs ) << 32 ) /
+                                        ( ullTsc - ullCalibrationTsc ) );
+        __int128 xSlope = xRate + xRate * ( ( __int128 ) ullTrueNs - ( __int128 ) ullNs ) / ( __int128 ) runtimeANCHOR_PERIOD_NS;
+
+        /* Far off - say after the host was suspended - the correction is
+         * spread over several periods. */
+        if( xSlope < xRate / 2 )
+        {
+            xSlope = xRate / 2;
+        }
+        else if( xSlope > xRate * 2 )
+        {
+            xSlope = xRate * 2;
+        }
+
+        prvWriteTscClock( ullTsc, ullNs, ( uint64_t ) xSlope,
+                          ullTsc + ( uint64_t ) ( ( ( unsigned __int128 ) runtimeANCHOR_PERIOD_NS << 32 ) / ( uint64_t ) xRate ) );
+
+        __atomic_store_n( &ulAnchoring, 0U, __ATOMIC_RELEASE );
+    }
+/*-----------------------------------------------------------*/
+
+    static uint64_t prvTscNs( void )
+    {
+        uint32_t ulSequence;
+        uint64_t ullTscBase, ullNsBase, ullMult, ullNextAnchor, ullTsc;
+
+        do
+        {
+            ulSequence = __atomic_load_n( &xTsc.ulSequence, __ATOMIC_ACQUIRE );
+            ullTscBase = __atomic_load_n( &xTsc.ullTscBase, __ATOMIC_RELAXED );
+            ullNsBase = __atomic_load_n( &xTsc.ullNsBase, __ATOMIC_RELAXED );
+            ullMult = __atomic_load_n( &xTsc.ullMult, __ATOMIC_RELAXED );
+            ullNextAnchor = __atomic_load_n( &xTsc.ullNextAnchor, __ATOMIC_RELAXED );
+            ullTsc = __rdtsc();
+            __atomic_thread_fence( __ATOMIC_ACQUIRE );
+        } while( ( ( ulSequence & 1U ) != 0U ) || ( ulSequence != __atomic_load_n( &xTsc.ulSequence, __ATOMIC_RELAXED ) ) );
+
+        if( ullTsc >= ullNextAnchor )
+        {
+            prvAnchorTsc();
+        }
+
+        return prvTscToNs( ullTsc, ullTscBase, ullNsBase, ullMult );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* runtimeHAS_TSC */
+
+void vConfigureTimerForRunTimeStats( void )
+{
+    ullStartTimeNs = prvMonotonicNs();
+
+    #if ( runtimeHAS_TSC == 1 )
+        if( prvHasInvariantTsc() == pdTRUE )
+        {
+            prvCalibrateTsc();
+        }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullGetRunTimeNs( void )
+{
+    #if ( runtimeHAS_TSC == 1 )
+        if( xUseTsc == pdTRUE )
+        {
+            return prvTscNs();
+        }
+    #endif
+
+    return prvMonotonicNs() - ullStartTimeNs;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullGetRunTimeCounterValue( void )
+{
+    #if ( projRUN_TIME_RESOLUTION == runtimeRESOLUTION_NS )
+        return ullGetRunTimeNs();
+    #else
+        return ullGetRunTimeNs() / ( 1000000000ULL / runtimeCOUNTS_PER_SECOND );
+    #endif
 }
 /*-----------------------------------------------------------*/
 
 unsigned long ulGetRunTimeCounterValue( void )
 {
-    struct timespec xNow;
+    return ( unsigned long ) ullGetRunTimeCounterValue();
+}
+/*-----------------------------------------------------------*/
 
-    /* Time at start. */
-    clock_gettime( CLOCK_MONOTONIC, &xNow );
+const char * pcRunTimeClockName( void )
+{
+    #if ( runtimeHAS_TSC == 1 )
+        if( xUseTsc == pdTRUE )
+        {
+            return "tsc";
+        }
+    #endif
 
-    return xNow.tv_sec * 1000000000ul + xNow.tv_nsec - ulStartTimeNs;
+    return "monotonic";
 }
 /*-----------------------------------------------------------*/
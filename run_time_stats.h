@@ -0,0 +1,99 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef RUN_TIME_STATS_H
+    #define RUN_TIME_STATS_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* The run time counter - see run-time-stats-utils.c.
+*
+* It counts from the start of the scheduler in nanoseconds, microseconds or
+* RTOS ticks, as chosen at build time with projRUN_TIME_RESOLUTION (make
+* RUN_TIME_RESOLUTION=ns|us|ticks), on 64 bits: ullGetRunTimeCounterValue()
+* does not wrap in any run.  ulGetRunTimeCounterValue(), used by the kernel
+* and the demos, is the same value as an unsigned long - differences of two
+* readings stay right on hosts where it is 32 bits, for intervals shorter
+* than its range.
+*
+* Where the CPU has an invariant time stamp counter, reading the clock is a
+* RDTSC and a multiplication instead of a clock_gettime() call.  The rate of
+* the TSC is calibrated against CLOCK_MONOTONIC when the scheduler starts,
+* and the conversion is brought back to CLOCK_MONOTONIC every second,
+* smoothly, so that the counter never goes back.  make RUN_TIME_TSC=0 reads
+* CLOCK_MONOTONIC every time.
+*----------------------------------------------------------*/
+
+    #define runtimeRESOLUTION_NS       ( 0 )
+    #define runtimeRESOLUTION_US       ( 1 )
+    #define runtimeRESOLUTION_TICKS    ( 2 )
+
+    #ifndef projRUN_TIME_RESOLUTION
+        #define projRUN_TIME_RESOLUTION    runtimeRESOLUTION_NS
+    #endif
+
+    #if ( projRUN_TIME_RESOLUTION == runtimeRESOLUTION_NS )
+        #define runtimeCOUNTS_PER_SECOND    ( 1000000000ULL )
+        #define runtimeUNIT_NAME            "ns"
+        #define runtimeCOUNTS_TO_US( ullCounts )    ( ( uint64_t ) ( ullCounts ) / 1000ULL )
+    #elif ( projRUN_TIME_RESOLUTION == runtimeRESOLUTION_US )
+        #define runtimeCOUNTS_PER_SECOND    ( 1000000ULL )
+        #define runtimeUNIT_NAME            "us"
+        #define runtimeCOUNTS_TO_US( ullCounts )    ( ( uint64_t ) ( ullCounts ) )
+    #elif ( projRUN_TIME_RESOLUTION == runtimeRESOLUTION_TICKS )
+        #define runtimeCOUNTS_PER_SECOND    ( ( unsigned long long ) configTICK_RATE_HZ )
+        #define runtimeUNIT_NAME            "ticks"
+        #define runtimeCOUNTS_TO_US( ullCounts )    ( ( uint64_t ) ( ullCounts ) * ( 1000000ULL / configTICK_RATE_HZ ) )
+    #else
+        #error projRUN_TIME_RESOLUTION should be runtimeRESOLUTION_NS, _US or _TICKS
+    #endif
+
+    #define runtimeCOUNTS_PER_MS      ( runtimeCOUNTS_PER_SECOND / 1000ULL )
+    #define runtimeCOUNTS_PER_TICK    ( runtimeCOUNTS_PER_SECOND / configTICK_RATE_HZ )
+
+/* runtimeCOUNTS_TO_US() converts a number of counts to microseconds, for the
+ * reports that print times in us whatever the resolution. */
+
+    uint64_t ullGetRunTimeCounterValue( void );
+
+/* Nanoseconds since the scheduler started, whatever the resolution. */
+    uint64_t ullGetRunTimeNs( void );
+
+/* "tsc" or "monotonic". */
+    const char * pcRunTimeClockName( void );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* RUN_TIME_STATS_H */
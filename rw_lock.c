@@ -0,0 +1,381 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Readers-writer lock with a choice of policy - see rw_lock.h.
+*----------------------------------------------------------*/
+
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "rw_lock.h"
+
+static const char * const pcPolicyNames[ eRwLockPolicyCount ] =
+{
+    [ eRwLockReaderPreference ] = "reader-pref",
+    [ eRwLockWriterPreference ] = "writer-pref",
+    [ eRwLockPhaseFair ]        = "phase-fair"
+};
+
+/*-----------------------------------------------------------*/
+
+const char * pcRwLockPolicyName( RwLockPolicy_t xPolicy )
+{
+    return ( xPolicy < eRwLockPolicyCount ) ? pcPolicyNames[ xPolicy ] : "?";
+}
+/*-----------------------------------------------------------*/
+
+void vRwLockInit( RwLock_t * pxLock,
+                  RwLockPolicy_t xPolicy )
+{
+    memset( pxLock, 0, sizeof( *pxLock ) );
+    pxLock->xPolicy = xPolicy;
+    pxLock->xMutex = xSemaphoreCreateMutexStatic( &pxLock->xMutexBuffer );
+    pxLock->xReadersGo = xSemaphoreCreateCountingStatic( rwlockMAX_READERS, 0, &pxLock->xReadersGoBuffer );
+    pxLock->xWriterGo = xSemaphoreCreateBinaryStatic( &pxLock->xWriterGoBuffer );
+    pxLock->xUpgraderGo = xSemaphoreCreateBinaryStatic( &pxLock->xUpgraderGoBuffer );
+    pxLock->xUpgradeGo = xSemaphoreCreateBinaryStatic( &pxLock->xUpgradeGoBuffer );
+}
+/*-----------------------------------------------------------*/
+
+void vRwLockDelete( RwLock_t * pxLock )
+{
+    vSemaphoreDelete( pxLock->xMutex );
+    vSemaphoreDelete( pxLock->xReadersGo );
+    vSemaphoreDelete( pxLock->xWriterGo );
+    vSemaphoreDelete( pxLock->xUpgraderGo );
+    vSemaphoreDelete( pxLock->xUpgradeGo );
+}
+/*-----------------------------------------------------------*/
+
+/* The state is only held for a few instructions, but a wait aborted with
+ * xTaskAbortDelay() must not be taken for the mutex. */
+static void prvLockState( RwLock_t * pxLock )
+{
+    while( xSemaphoreTake( pxLock->xMutex, portMAX_DELAY ) != pdTRUE )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnlockState( RwLock_t * pxLock )
+{
+    xSemaphoreGive( pxLock->xMutex );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCanRead( const RwLock_t * pxLock )
+{
+    return ( pxLock->xWriterActive == pdFALSE ) &&
+           ( pxLock->xUpgradePending == pdFALSE ) &&
+           ( ( pxLock->xPolicy == eRwLockReaderPreference ) || ( pxLock->uxWaitingWriters == 0 ) );
+}
+/*-----------------------------------------------------------*/
+
+/* An upgrader enters like a reader, if it is the only one. */
+static BaseType_t prvCanReadUpgradable( const RwLock_t * pxLock )
+{
+    return ( pxLock->xUpgraderActive == pdFALSE ) && prvCanRead( pxLock );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCanWrite( const RwLock_t * pxLock )
+{
+    /* Waiting writers go first, in the order the kernel wakes them. */
+    return ( pxLock->xWriterActive == pdFALSE ) &&
+           ( pxLock->uxActiveReaders == 0 ) &&
+           ( pxLock->uxWaitingWriters == 0 );
+}
+/*-----------------------------------------------------------*/
+
+/* Lets the waiting tasks in, if the policy allows it, once the lock has been
+ * left or a waiting task has given up.  Called with xMutex held. */
+static void prvAdmitWaiters( RwLock_t * pxLock,
+                             BaseType_t xWriterLeft )
+{
+    BaseType_t xReadersFirst;
+
+    if( pxLock->xWriterActive == pdTRUE )
+    {
+        return;
+    }
+
+    /* The pending upgrade goes before anybody else - the upgrader has not
+     * left the lock. */
+    if( pxLock->xUpgradePending == pdTRUE )
+    {
+        if( pxLock->uxActiveReaders == 0 )
+        {
+            pxLock->xUpgradePending = pdFALSE;
+            pxLock->xWriterActive = pdTRUE;
+            pxLock->ulUpgrades++;
+            xSemaphoreGive( pxLock->xUpgradeGo );
+        }
+
+        return;
+    }
+
+    xReadersFirst = ( pxLock->xPolicy == eRwLockReaderPreference ) ||
+                    ( ( pxLock->xPolicy == eRwLockPhaseFair ) && ( xWriterLeft == pdTRUE ) ) ||
+                    ( pxLock->uxWaitingWriters == 0 );
+
+    if( ( pxLock->uxWaitingReaders > 0 ) && ( xReadersFirst == pdTRUE ) )
+    {
+        UBaseType_t uxReaders = pxLock->uxWaitingReaders;
+
+        pxLock->uxActiveReaders += uxReaders;
+        pxLock->uxWaitingReaders = 0;
+        pxLock->ulReadLocks += uxReaders;
+
+        while( uxReaders-- > 0 )
+        {
+            xSemaphoreGive( pxLock->xReadersGo );
+        }
+    }
+    else if( ( pxLock->uxWaitingWriters > 0 ) && ( pxLock->uxActiveReaders == 0 ) )
+    {
+        pxLock->uxWaitingWriters--;
+        pxLock->xWriterActive = pdTRUE;
+        pxLock->ulWriteLocks++;
+        xSemaphoreGive( pxLock->xWriterGo );
+    }
+
+    if( ( pxLock->uxWaitingUpgraders > 0 ) && ( prvCanReadUpgradable( pxLock ) == pdTRUE ) )
+    {
+        pxLock->uxWaitingUpgraders--;
+        pxLock->xUpgraderActive = pdTRUE;
+        pxLock->uxActiveReaders++;
+        pxLock->ulUpgradableLocks++;
+        xSemaphoreGive( pxLock->xUpgraderGo );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Blocks on xGo until let in by prvAdmitWaiters().  On a timeout, the task may
+ * have been let in after all, in which case xGo has been given for it: every
+ * waiting task takes one give, so whichever task takes it is the one let in,
+ * and the others are still counted as waiting. */
+static BaseType_t prvWait( RwLock_t * pxLock,
+                           SemaphoreHandle_t xGo,
+                           UBaseType_t * puxWaiting,
+                           TickType_t xTicksToWait )
+{
+    if( xSemaphoreTake( xGo, xTicksToWait ) == pdTRUE )
+    {
+        return pdTRUE;
+    }
+
+    prvLockState( pxLock );
+
+    if( xSemaphoreTake( xGo, 0 ) == pdTRUE )
+    {
+        prvUnlockState( pxLock );
+        return pdTRUE;
+    }
+
+    ( *puxWaiting )--;
+    pxLock->ulTimeouts++;
+
+    /* A writer that gave up may have been all that held the readers back. */
+    prvAdmitWaiters( pxLock, pdFALSE );
+    prvUnlockState( pxLock );
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRwLockReadLock( RwLock_t * pxLock,
+                            TickType_t xTicksToWait )
+{
+    prvLockState( pxLock );
+
+    if( prvCanRead( pxLock ) == pdTRUE )
+    {
+        pxLock->uxActiveReaders++;
+        pxLock->ulReadLocks++;
+        prvUnlockState( pxLock );
+        return pdTRUE;
+    }
+
+    if( xTicksToWait == 0 )
+    {
+        pxLock->ulTimeouts++;
+        prvUnlockState( pxLock );
+        return pdFALSE;
+    }
+
+    configASSERT( pxLock->uxWaitingReaders < rwlockMAX_READERS );
+    pxLock->uxWaitingReaders++;
+    pxLock->ulReadBlocks++;
+    prvUnlockState( pxLock );
+
+    return prvWait( pxLock, pxLock->xReadersGo, &pxLock->uxWaitingReaders, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+void vRwLockReadUnlock( RwLock_t * pxLock )
+{
+    prvLockState( pxLock );
+    configASSERT( pxLock->uxActiveReaders > 0 );
+    pxLock->uxActiveReaders--;
+    prvAdmitWaiters( pxLock, pdFALSE );
+    prvUnlockState( pxLock );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRwLockWriteLock( RwLock_t * pxLock,
+                             TickType_t xTicksToWait )
+{
+    prvLockState( pxLock );
+
+    if( prvCanWrite( pxLock ) == pdTRUE )
+    {
+        pxLock->xWriterActive = pdTRUE;
+        pxLock->ulWriteLocks++;
+        prvUnlockState( pxLock );
+        return pdTRUE;
+    }
+
+    if( xTicksToWait == 0 )
+    {
+        pxLock->ulTimeouts++;
+        prvUnlockState( pxLock );
+        return pdFALSE;
+    }
+
+    pxLock->uxWaitingWriters++;
+    pxLock->ulWriteBlocks++;
+    prvUnlockState( pxLock );
+
+    return prvWait( pxLock, pxLock->xWriterGo, &pxLock->uxWaitingWriters, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+void vRwLockWriteUnlock( RwLock_t * pxLock )
+{
+    prvLockState( pxLock );
+    configASSERT( pxLock->xWriterActive == pdTRUE );
+    pxLock->xWriterActive = pdFALSE;
+
+    /* Only an upgrader can be writing while it is set. */
+    pxLock->xUpgraderActive = pdFALSE;
+    prvAdmitWaiters( pxLock, pdTRUE );
+    prvUnlockState( pxLock );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRwLockUpgradableLock( RwLock_t * pxLock,
+                                  TickType_t xTicksToWait )
+{
+    prvLockState( pxLock );
+
+    if( prvCanReadUpgradable( pxLock ) == pdTRUE )
+    {
+        pxLock->xUpgraderActive = pdTRUE;
+        pxLock->uxActiveReaders++;
+        pxLock->ulUpgradableLocks++;
+        prvUnlockState( pxLock );
+        return pdTRUE;
+    }
+
+    if( xTicksToWait == 0 )
+    {
+        pxLock->ulTimeouts++;
+        prvUnlockState( pxLock );
+        return pdFALSE;
+    }
+
+    pxLock->uxWaitingUpgraders++;
+    pxLock->ulReadBlocks++;
+    prvUnlockState( pxLock );
+
+    return prvWait( pxLock, pxLock->xUpgraderGo, &pxLock->uxWaitingUpgraders, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+void vRwLockUpgradableUnlock( RwLock_t * pxLock )
+{
+    prvLockState( pxLock );
+    configASSERT( ( pxLock->xUpgraderActive == pdTRUE ) && ( pxLock->uxActiveReaders > 0 ) );
+    pxLock->xUpgraderActive = pdFALSE;
+    pxLock->uxActiveReaders--;
+    prvAdmitWaiters( pxLock, pdFALSE );
+    prvUnlockState( pxLock );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRwLockUpgrade( RwLock_t * pxLock,
+                           TickType_t xTicksToWait )
+{
+    prvLockState( pxLock );
+    configASSERT( ( pxLock->xUpgraderActive == pdTRUE ) && ( pxLock->xWriterActive == pdFALSE ) );
+
+    /* The upgrader stops counting as a reader, but keeps xUpgraderActive so
+     * that no writer can enter before it. */
+    pxLock->uxActiveReaders--;
+
+    if( pxLock->uxActiveReaders == 0 )
+    {
+        pxLock->xWriterActive = pdTRUE;
+        pxLock->ulUpgrades++;
+        prvUnlockState( pxLock );
+        return pdTRUE;
+    }
+
+    pxLock->xUpgradePending = pdTRUE;
+    pxLock->ulUpgradeBlocks++;
+    prvUnlockState( pxLock );
+
+    if( xSemaphoreTake( pxLock->xUpgradeGo, xTicksToWait ) == pdTRUE )
+    {
+        return pdTRUE;
+    }
+
+    prvLockState( pxLock );
+
+    /* Granted after all, between the timeout and here. */
+    if( xSemaphoreTake( pxLock->xUpgradeGo, 0 ) == pdTRUE )
+    {
+        prvUnlockState( pxLock );
+        return pdTRUE;
+    }
+
+    /* Back to an upgradable read lock, and let in the readers held back by
+     * the upgrade. */
+    pxLock->xUpgradePending = pdFALSE;
+    pxLock->uxActiveReaders++;
+    pxLock->ulTimeouts++;
+    prvAdmitWaiters( pxLock, pdFALSE );
+    prvUnlockState( pxLock );
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
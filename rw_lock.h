@@ -0,0 +1,146 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef RW_LOCK_H
+    #define RW_LOCK_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "semphr.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Readers-writer lock with a choice of policy.
+*
+* The state of the lock - active and waiting readers and writers - is only
+* changed with xMutex held, a real FreeRTOS mutex that is given back by the
+* task that took it, after a few instructions.  Tasks that cannot enter block
+* on xReadersGo (readers) or xWriterGo (writers), and are let in by the task
+* that unlocks: it counts them as active before it gives the semaphores, so
+* nobody can slip in between.
+*
+* - eRwLockReaderPreference: readers enter whenever no writer is active, so a
+*   steady flow of readers starves the writers.
+* - eRwLockWriterPreference: readers do not enter while a writer is waiting,
+*   and a leaving writer hands over to the next writer first, so the readers
+*   may starve instead.
+* - eRwLockPhaseFair: readers do not enter while a writer is waiting, but a
+*   leaving writer lets in all the waiting readers first - read and write
+*   phases alternate, and neither side can starve.
+*
+* One task at a time may hold an upgradable read lock instead: it reads next
+* to the ordinary readers, counted as one of them, and may later upgrade it
+* to the write lock without letting any writer in between - for writers that
+* read the state first to decide whether to change it.  While an upgrade is
+* pending no new reader enters, and the last reader to leave hands the lock
+* over to the upgrader.  An upgraded lock is left with vRwLockWriteUnlock().
+*----------------------------------------------------------*/
+
+/* Most tasks that can wait for a read lock at the same time. */
+    #ifndef rwlockMAX_READERS
+        #define rwlockMAX_READERS    ( 1024U )
+    #endif
+
+    typedef enum
+    {
+        eRwLockReaderPreference = 0,
+        eRwLockWriterPreference,
+        eRwLockPhaseFair,
+        eRwLockPolicyCount
+    } RwLockPolicy_t;
+
+    typedef struct RwLock
+    {
+        RwLockPolicy_t xPolicy;
+        SemaphoreHandle_t xMutex;
+        SemaphoreHandle_t xReadersGo;
+        SemaphoreHandle_t xWriterGo;
+        SemaphoreHandle_t xUpgraderGo; /* An upgradable read lock is granted. */
+        SemaphoreHandle_t xUpgradeGo;  /* The pending upgrade is granted. */
+        StaticSemaphore_t xMutexBuffer;
+        StaticSemaphore_t xReadersGoBuffer;
+        StaticSemaphore_t xWriterGoBuffer;
+        StaticSemaphore_t xUpgraderGoBuffer;
+        StaticSemaphore_t xUpgradeGoBuffer;
+
+        /* Protected by xMutex. */
+        UBaseType_t uxActiveReaders;
+        UBaseType_t uxWaitingReaders;
+        UBaseType_t uxWaitingWriters;
+        BaseType_t xWriterActive;
+        UBaseType_t uxWaitingUpgraders;
+        BaseType_t xUpgraderActive;  /* Held upgradable, or upgraded. */
+        BaseType_t xUpgradePending;  /* Waiting for the readers to leave. */
+
+        /* Statistics, not reset by the lock. */
+        uint32_t ulReadLocks;
+        uint32_t ulWriteLocks;
+        uint32_t ulReadBlocks;   /* Read locks that had to wait. */
+        uint32_t ulWriteBlocks;  /* Write locks that had to wait. */
+        uint32_t ulTimeouts;     /* Locks not obtained in time. */
+        uint32_t ulUpgradableLocks;
+        uint32_t ulUpgrades;
+        uint32_t ulUpgradeBlocks; /* Upgrades that had to wait for readers. */
+    } RwLock_t;
+
+    void vRwLockInit( RwLock_t * pxLock,
+                      RwLockPolicy_t xPolicy );
+    void vRwLockDelete( RwLock_t * pxLock );
+
+/*
+ * Return pdTRUE once the lock is held, or pdFALSE if it could not be obtained
+ * within xTicksToWait (0 never waits) or the wait was aborted.
+ */
+    BaseType_t xRwLockReadLock( RwLock_t * pxLock,
+                                TickType_t xTicksToWait );
+    void vRwLockReadUnlock( RwLock_t * pxLock );
+    BaseType_t xRwLockWriteLock( RwLock_t * pxLock,
+                                 TickType_t xTicksToWait );
+    void vRwLockWriteUnlock( RwLock_t * pxLock );
+
+/*
+ * xRwLockUpgrade() turns a held upgradable read lock into the write lock.  If
+ * the upgrade is not granted within xTicksToWait it returns pdFALSE, and the
+ * upgradable read lock is still held.
+ */
+    BaseType_t xRwLockUpgradableLock( RwLock_t * pxLock,
+                                      TickType_t xTicksToWait );
+    void vRwLockUpgradableUnlock( RwLock_t * pxLock );
+    BaseType_t xRwLockUpgrade( RwLock_t * pxLock,
+                               TickType_t xTicksToWait );
+
+    const char * pcRwLockPolicyName( RwLockPolicy_t xPolicy );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* RW_LOCK_H */
@@ -0,0 +1,318 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Per-object semaphore profiler - see sem_profiler.h.
+*----------------------------------------------------------*/
+
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+/* Local includes. */
+#include "sem_profiler.h"
+
+#if ( projSEM_PROFILER == 1 )
+
+    #include "console.h"
+    #include "latency_histogram.h"
+    #include "run_time_stats.h"
+
+    typedef struct SemProfile
+    {
+        const char * pcName;     /* NULL for a free row. */
+        BaseType_t xTrackHold;   /* One token: a mutex or a binary semaphore. */
+        unsigned long ulTakenAt; /* 0 while the token is not taken. */
+
+        uint32_t ulTakes;
+        uint32_t ulBlocked;      /* Takes that blocked first. */
+        uint32_t ulFailed;       /* Updated atomically - see vSemProfilerTakeFailed(). */
+        uint32_t ulGives;
+        LatencyHistogram_t xWait;
+        LatencyHistogram_t xHold;
+    } SemProfile_t;
+
+/*-----------------------------------------------------------*/
+
+/* Returns the number the hooks are given for pcName, 0 if the table is full. */
+    static UBaseType_t prvRegister( const char * pcName,
+                                    BaseType_t xTrackHold );
+
+/* Returns the start of the wait of the calling task, if any, and clears it. */
+    static unsigned long prvEndWait( void );
+
+    static void prvReportFromTimer( void * pvParameter,
+                                    uint32_t ulParameter );
+
+/*-----------------------------------------------------------*/
+
+    static SemProfile_t xRows[ semprofilerMAX_OBJECTS ];
+    static uint32_t ulNotRegistered = 0;
+
+/*-----------------------------------------------------------*/
+
+    void vSemProfilerRegister( SemaphoreHandle_t xSemaphore,
+                               const char * pcName )
+    {
+        UBaseType_t uxTokens = uxQueueMessagesWaiting( xSemaphore ) + uxQueueSpacesAvailable( xSemaphore );
+
+        vQueueSetQueueNumber( xSemaphore, prvRegister( pcName, ( uxTokens == 1U ) ? pdTRUE : pdFALSE ) );
+    }
+/*-----------------------------------------------------------*/
+
+    void vSemProfilerRegisterEventGroup( EventGroupHandle_t xEventGroup,
+                                         const char * pcName )
+    {
+        vEventGroupSetNumber( xEventGroup, prvRegister( pcName, pdFALSE ) );
+    }
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvRegister( const char * pcName,
+                                    BaseType_t xTrackHold )
+    {
+        UBaseType_t uxRow = 0;
+
+        taskENTER_CRITICAL();
+        {
+            while( ( uxRow < semprofilerMAX_OBJECTS ) && ( xRows[ uxRow ].pcName != NULL ) &&
+                   ( strcmp( xRows[ uxRow ].pcName, pcName ) != 0 ) )
+            {
+                uxRow++;
+            }
+
+            if( uxRow < semprofilerMAX_OBJECTS )
+            {
+                if( xRows[ uxRow ].pcName == NULL )
+                {
+                    vHistogramReset( &xRows[ uxRow ].xWait );
+                    vHistogramReset( &xRows[ uxRow ].xHold );
+                    xRows[ uxRow ].pcName = pcName;
+                }
+
+                /* A new object, which nobody holds yet. */
+                xRows[ uxRow ].xTrackHold = xTrackHold;
+                xRows[ uxRow ].ulTakenAt = 0;
+            }
+            else
+            {
+                ulNotRegistered++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return ( uxRow < semprofilerMAX_OBJECTS ) ? uxRow + 1U : 0U;
+    }
+/*-----------------------------------------------------------*/
+
+    static unsigned long prvEndWait( void )
+    {
+        void * pvStart = pvTaskGetThreadLocalStoragePointer( NULL, semprofilerTLS_INDEX );
+
+        if( pvStart != NULL )
+        {
+            vTaskSetThreadLocalStoragePointer( NULL, semprofilerTLS_INDEX, NULL );
+        }
+
+        return ( unsigned long ) ( uintptr_t ) pvStart;
+    }
+/*-----------------------------------------------------------*/
+
+    void vSemProfilerBlocking( unsigned long ulObject )
+    {
+        ( void ) ulObject;
+
+        /* The take may block again after a wake-up that came too late: the
+         * wait starts the first time. */
+        if( pvTaskGetThreadLocalStoragePointer( NULL, semprofilerTLS_INDEX ) == NULL )
+        {
+            unsigned long ulNow = ulGetRunTimeCounterValue();
+
+            /* 0 is reserved for "not waiting". */
+            vTaskSetThreadLocalStoragePointer( NULL, semprofilerTLS_INDEX, ( void * ) ( uintptr_t ) ( ( ulNow != 0 ) ? ulNow : 1 ) );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vSemProfilerTaken( unsigned long ulObject )
+    {
+        SemProfile_t * pxRow = &xRows[ ulObject - 1U ];
+        unsigned long ulStart;
+        unsigned long ulNow;
+
+        pxRow->ulTakes++;
+
+        /* Before the scheduler starts there is no task, nor clock. */
+        if( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED )
+        {
+            return;
+        }
+
+        ulStart = prvEndWait();
+
+        if( ( ulStart == 0 ) && ( pxRow->xTrackHold == pdFALSE ) )
+        {
+            /* The common case costs no clock reading. */
+            vHistogramRecord( &pxRow->xWait, 0 );
+            return;
+        }
+
+        ulNow = ulGetRunTimeCounterValue();
+
+        if( ulStart != 0 )
+        {
+            pxRow->ulBlocked++;
+            vHistogramRecord( &pxRow->xWait, ulNow - ulStart );
+        }
+        else
+        {
+            vHistogramRecord( &pxRow->xWait, 0 );
+        }
+
+        if( pxRow->xTrackHold == pdTRUE )
+        {
+            pxRow->ulTakenAt = ( ulNow != 0 ) ? ulNow : 1;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vSemProfilerTakeFailed( unsigned long ulObject )
+    {
+        /* Called outside of any critical section - the take timed out. */
+        if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+        {
+            ( void ) prvEndWait();
+        }
+
+        ( void ) __atomic_fetch_add( &xRows[ ulObject - 1U ].ulFailed, 1U, __ATOMIC_RELAXED );
+    }
+/*-----------------------------------------------------------*/
+
+    void vSemProfilerGiven( unsigned long ulObject )
+    {
+        SemProfile_t * pxRow = &xRows[ ulObject - 1U ];
+
+        pxRow->ulGives++;
+
+        if( pxRow->ulTakenAt != 0 )
+        {
+            vHistogramRecord( &pxRow->xHold, ulGetRunTimeCounterValue() - pxRow->ulTakenAt );
+            pxRow->ulTakenAt = 0;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vSemProfilerSyncEnd( unsigned long ulObject,
+                              long lTimedOut )
+    {
+        SemProfile_t * pxRow = &xRows[ ulObject - 1U ];
+        unsigned long ulStart = prvEndWait();
+        unsigned long ulWait = ( ulStart != 0 ) ? ulGetRunTimeCounterValue() - ulStart : 0;
+
+        /* Called outside of any critical section. */
+        taskENTER_CRITICAL();
+        {
+            if( lTimedOut != 0 )
+            {
+                pxRow->ulFailed++;
+            }
+            else
+            {
+                pxRow->ulTakes++;
+                pxRow->ulBlocked += ( ulStart != 0 ) ? 1U : 0U;
+                vHistogramRecord( &pxRow->xWait, ulWait );
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    void vSemProfilerReport( void )
+    {
+        /* Too large for the stack of the timer task. */
+        static SemProfile_t xRow;
+
+        console_print( "Semaphore profile (%s)\n", runtimeUNIT_NAME );
+        console_print( "%-18s %9s %9s %9s %9s %10s %10s %10s %10s %10s %10s\n",
+                       "Object", "Takes", "Blocked", "Failed", "Gives",
+                       "Wait mean", "Wait p99", "Wait max", "Hold mean", "Hold p99", "Hold max" );
+
+        for( UBaseType_t uxRow = 0; uxRow < semprofilerMAX_OBJECTS; uxRow++ )
+        {
+            taskENTER_CRITICAL();
+            {
+                xRow = xRows[ uxRow ];
+            }
+            taskEXIT_CRITICAL();
+
+            if( xRow.pcName == NULL )
+            {
+                break;
+            }
+
+            console_print( "%-18s %9lu %9lu %9lu %9lu %10llu %10llu %10llu %10llu %10llu %10llu\n",
+                           xRow.pcName,
+                           ( unsigned long ) xRow.ulTakes,
+                           ( unsigned long ) xRow.ulBlocked,
+                           ( unsigned long ) xRow.ulFailed,
+                           ( unsigned long ) xRow.ulGives,
+                           ( unsigned long long ) ullHistogramMean( &xRow.xWait ),
+                           ( unsigned long long ) ullHistogramPercentile( &xRow.xWait, 99.0 ),
+                           ( unsigned long long ) xRow.xWait.ullMax,
+                           ( unsigned long long ) ullHistogramMean( &xRow.xHold ),
+                           ( unsigned long long ) ullHistogramPercentile( &xRow.xHold, 99.0 ),
+                           ( unsigned long long ) xRow.xHold.ullMax );
+        }
+
+        if( ulNotRegistered > 0 )
+        {
+            console_print( "%lu object(s) not profiled, the table is full\n", ( unsigned long ) ulNotRegistered );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vSemProfilerRequestReport( void )
+    {
+        ( void ) xTimerPendFunctionCall( prvReportFromTimer, NULL, 0, 0 );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvReportFromTimer( void * pvParameter,
+                                    uint32_t ulParameter )
+    {
+        ( void ) pvParameter;
+        ( void ) ulParameter;
+
+        vSemProfilerReport();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* projSEM_PROFILER == 1 */
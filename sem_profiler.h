@@ -0,0 +1,93 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef SEM_PROFILER_H
+    #define SEM_PROFILER_H
+
+    #include "FreeRTOS.h"
+    #include "semphr.h"
+    #include "event_groups.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Per-object semaphore profiler on the kernel trace macros.
+*
+* Built with 'make SEM_PROFILER=1', which replaces the FreeRTOS+Trace
+* recorder by the hooks of sem_profiler_hooks.h; otherwise the functions below
+* compile to nothing.  Only the semaphores and event groups given to
+* vSemProfilerRegister...() are profiled, under their name - the objects
+* registered under the same name, such as the successive incarnations of a
+* semaphore created for each run, share a row.  For each, the profiler counts:
+* - the takes, those that had to block first, and those that failed - timed
+*   out, or were aborted;
+* - the wait: from the first time a take blocks until it succeeds, 0 for the
+*   takes that did not block;
+* - the hold: from a take until the next give, for the semaphores of one
+*   token only - mutexes and binary semaphores;
+* - the gives, from tasks or interrupts.
+* A wait for the bits of an event group, or a rendez-vous, counts as a take.
+*
+* The hooks run inside the kernel's own critical sections, or with the
+* scheduler suspended, except those of failed takes and of the end of an
+* event group wait.  The start of a wait is kept in the thread local storage
+* pointer semprofilerTLS_INDEX of the waiting task.  Times are in run time
+* counter units - see ulGetRunTimeCounterValue().
+*----------------------------------------------------------*/
+
+    #define semprofilerMAX_OBJECTS    ( 16U )
+    #define semprofilerTLS_INDEX      ( 1 )
+
+    #if ( projSEM_PROFILER == 1 )
+
+/* Call them once the object is created - a full table is reported. */
+        void vSemProfilerRegister( SemaphoreHandle_t xSemaphore,
+                                   const char * pcName );
+        void vSemProfilerRegisterEventGroup( EventGroupHandle_t xEventGroup,
+                                             const char * pcName );
+
+/* Prints the table with console_print(), from a task that may block. */
+        void vSemProfilerReport( void );
+
+/* Has the timer task print the table - for the idle task, which may not block. */
+        void vSemProfilerRequestReport( void );
+
+    #else /* if ( projSEM_PROFILER == 1 ) */
+
+        #define vSemProfilerRegister( xSemaphore, pcName )
+        #define vSemProfilerRegisterEventGroup( xEventGroup, pcName )
+        #define vSemProfilerReport()
+        #define vSemProfilerRequestReport()
+
+    #endif /* if ( projSEM_PROFILER == 1 ) */
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* SEM_PROFILER_H */
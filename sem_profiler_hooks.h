@@ -0,0 +1,95 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef SEM_PROFILER_HOOKS_H
+    #define SEM_PROFILER_HOOKS_H
+
+/*-----------------------------------------------------------
+* Kernel trace macros of the semaphore profiler, included by FreeRTOSConfig.h
+* in place of trcRecorder.h when projSEM_PROFILER is 1 - see sem_profiler.h.
+*
+* The row of a registered object is kept, plus one, in the number the kernel
+* holds in every queue and event group for the tracing tools: the hooks of the
+* objects nobody registered cost a comparison with 0.  The macros are only
+* used inside queue.c and event_groups.c, where the structures are known.
+*
+* This file is included before the FreeRTOS types are defined.
+*----------------------------------------------------------*/
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+    void vSemProfilerBlocking( unsigned long ulObject );
+    void vSemProfilerTaken( unsigned long ulObject );
+    void vSemProfilerTakeFailed( unsigned long ulObject );
+    void vSemProfilerGiven( unsigned long ulObject );
+    void vSemProfilerSyncEnd( unsigned long ulObject,
+                              long lTimedOut );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+/* Calls xHook if the object is registered. */
+    #define semprofilerHOOK( uxNumber, xHook ) \
+    do {                                       \
+        if( ( uxNumber ) != 0U )               \
+        {                                      \
+            xHook;                             \
+        }                                      \
+    } while( 0 )
+
+/* The kernel does not initialise the numbers. */
+    #define traceQUEUE_CREATE( pxNewQueue )    ( pxNewQueue )->uxQueueNumber = 0U
+    #define traceEVENT_GROUP_CREATE( xEventGroup )    ( xEventGroup )->uxEventGroupNumber = 0U
+
+/* Semaphores - the take and give of a semaphore are the receive and send of
+ * its queue. */
+    #define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue ) \
+    semprofilerHOOK( ( pxQueue )->uxQueueNumber, vSemProfilerBlocking( ( pxQueue )->uxQueueNumber ) )
+    #define traceQUEUE_RECEIVE( pxQueue ) \
+    semprofilerHOOK( ( pxQueue )->uxQueueNumber, vSemProfilerTaken( ( pxQueue )->uxQueueNumber ) )
+    #define traceQUEUE_RECEIVE_FAILED( pxQueue ) \
+    semprofilerHOOK( ( pxQueue )->uxQueueNumber, vSemProfilerTakeFailed( ( pxQueue )->uxQueueNumber ) )
+    #define traceQUEUE_SEND( pxQueue ) \
+    semprofilerHOOK( ( pxQueue )->uxQueueNumber, vSemProfilerGiven( ( pxQueue )->uxQueueNumber ) )
+    #define traceQUEUE_SEND_FROM_ISR( pxQueue ) \
+    semprofilerHOOK( ( pxQueue )->uxQueueNumber, vSemProfilerGiven( ( pxQueue )->uxQueueNumber ) )
+
+/* Event groups - a wait for the bits, or a rendez-vous, is a take. */
+    #define traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor ) \
+    semprofilerHOOK( ( xEventGroup )->uxEventGroupNumber, vSemProfilerBlocking( ( xEventGroup )->uxEventGroupNumber ) )
+    #define traceEVENT_GROUP_WAIT_BITS_END( xEventGroup, uxBitsToWaitFor, xTimeoutOccurred ) \
+    semprofilerHOOK( ( xEventGroup )->uxEventGroupNumber,                                   \
+                     vSemProfilerSyncEnd( ( xEventGroup )->uxEventGroupNumber, ( long ) ( xTimeoutOccurred ) ) )
+    #define traceEVENT_GROUP_SYNC_BLOCK( xEventGroup, uxBitsToSet, uxBitsToWaitFor ) \
+    semprofilerHOOK( ( xEventGroup )->uxEventGroupNumber, vSemProfilerBlocking( ( xEventGroup )->uxEventGroupNumber ) )
+    #define traceEVENT_GROUP_SYNC_END( xEventGroup, uxBitsToSet, uxBitsToWaitFor, xTimeoutOccurred ) \
+    semprofilerHOOK( ( xEventGroup )->uxEventGroupNumber,                                           \
+                     vSemProfilerSyncEnd( ( xEventGroup )->uxEventGroupNumber, ( long ) ( xTimeoutOccurred ) ) )
+
+#endif /* SEM_PROFILER_HOOKS_H */
@@ -0,0 +1,154 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Starvation detector for writers - see starvation_monitor.h.
+*----------------------------------------------------------*/
+
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "starvation_monitor.h"
+#include "console.h"
+#include "run_time_stats.h"
+
+/*-----------------------------------------------------------*/
+
+void vStarvationMonitorInit( StarvationMonitor_t * pxMonitor,
+                             const char * pcName,
+                             uint32_t ulBoundMs )
+{
+    memset( pxMonitor, 0, sizeof( *pxMonitor ) );
+    pxMonitor->pcName = pcName;
+    pxMonitor->ulBound = ( unsigned long ) ulBoundMs * runtimeCOUNTS_PER_MS;
+    vHistogramReset( &pxMonitor->xWait );
+    vHistogramReset( &pxMonitor->xSkips );
+    vHistogramReset( &pxMonitor->xAge );
+}
+/*-----------------------------------------------------------*/
+
+void vStarvationMonitorRecord( StarvationMonitor_t * pxMonitor,
+                               unsigned long ulAttemptStart,
+                               BaseType_t xUpdated )
+{
+    unsigned long ulNow = ulGetRunTimeCounterValue();
+    unsigned long ulStarvedFor = 0;
+    uint32_t ulSkips = 0;
+    BaseType_t xAlarm = pdFALSE;
+    BaseType_t xRecovered = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        pxMonitor->ulAttempts++;
+
+        if( xUpdated == pdTRUE )
+        {
+            unsigned long ulFirstAttempt = ( pxMonitor->ulPendingSince != 0 ) ? pxMonitor->ulPendingSince : ulAttemptStart;
+
+            vHistogramRecord( &pxMonitor->xWait, ulNow - ulFirstAttempt );
+            vHistogramRecord( &pxMonitor->xSkips, pxMonitor->ulSkipsPending );
+
+            if( pxMonitor->ulLastUpdate != 0 )
+            {
+                vHistogramRecord( &pxMonitor->xAge, ulNow - pxMonitor->ulLastUpdate );
+            }
+
+            ulStarvedFor = ulNow - ulFirstAttempt;
+            ulSkips = pxMonitor->ulSkipsPending;
+            xRecovered = pxMonitor->xAlarmRaised;
+
+            pxMonitor->ulUpdates++;
+            pxMonitor->ulLastUpdate = ulNow;
+            pxMonitor->ulPendingSince = 0;
+            pxMonitor->ulSkipsPending = 0;
+            pxMonitor->xAlarmRaised = pdFALSE;
+        }
+        else
+        {
+            pxMonitor->ulSkipped++;
+            pxMonitor->ulSkipsPending++;
+
+            if( pxMonitor->ulPendingSince == 0 )
+            {
+                /* 0 is reserved for "nothing pending". */
+                pxMonitor->ulPendingSince = ( ulAttemptStart != 0 ) ? ulAttemptStart : 1;
+            }
+
+            ulStarvedFor = ulNow - pxMonitor->ulPendingSince;
+            ulSkips = pxMonitor->ulSkipsPending;
+
+            if( ( pxMonitor->xAlarmRaised == pdFALSE ) && ( pxMonitor->ulBound > 0 ) &&
+                ( ulStarvedFor > pxMonitor->ulBound ) )
+            {
+                pxMonitor->xAlarmRaised = pdTRUE;
+                pxMonitor->ulAlarms++;
+                xAlarm = pdTRUE;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    /* Printed outside of the critical section. */
+    if( xAlarm == pdTRUE )
+    {
+        console_print( "ALARM: %s starved for %lu ms, %lu attempt(s) skipped\n",
+                       pxMonitor->pcName, ulStarvedFor / runtimeCOUNTS_PER_MS, ( unsigned long ) ulSkips );
+    }
+    else if( xRecovered == pdTRUE )
+    {
+        console_print( "%s recovered after %lu ms, %lu attempt(s) skipped\n",
+                       pxMonitor->pcName, ulStarvedFor / runtimeCOUNTS_PER_MS, ( unsigned long ) ulSkips );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vStarvationMonitorReport( const StarvationMonitor_t * pxMonitor )
+{
+    console_print( "%s: %lu attempt(s), %lu update(s), %lu skipped, %lu alarm(s)\n",
+                   pxMonitor->pcName,
+                   ( unsigned long ) pxMonitor->ulAttempts,
+                   ( unsigned long ) pxMonitor->ulUpdates,
+                   ( unsigned long ) pxMonitor->ulSkipped,
+                   ( unsigned long ) pxMonitor->ulAlarms );
+    console_print( "%-12s %12s %12s %12s\n", "", "p50", "p99", "max" );
+    console_print( "%-12s %12llu %12llu %12llu\n", "Wait us",
+                   ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxMonitor->xWait, 50.0 ) ),
+                   ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxMonitor->xWait, 99.0 ) ),
+                   ( unsigned long long ) runtimeCOUNTS_TO_US( ( pxMonitor->xWait.ullCount > 0 ) ? pxMonitor->xWait.ullMax : 0 ) );
+    console_print( "%-12s %12llu %12llu %12llu\n", "Skips",
+                   ( unsigned long long ) ullHistogramPercentile( &pxMonitor->xSkips, 50.0 ),
+                   ( unsigned long long ) ullHistogramPercentile( &pxMonitor->xSkips, 99.0 ),
+                   ( unsigned long long ) ( ( pxMonitor->xSkips.ullCount > 0 ) ? pxMonitor->xSkips.ullMax : 0 ) );
+    console_print( "%-12s %12llu %12llu %12llu\n", "Age us",
+                   ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxMonitor->xAge, 50.0 ) ),
+                   ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxMonitor->xAge, 99.0 ) ),
+                   ( unsigned long long ) runtimeCOUNTS_TO_US( ( pxMonitor->xAge.ullCount > 0 ) ? pxMonitor->xAge.ullMax : 0 ) );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,96 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef STARVATION_MONITOR_H
+    #define STARVATION_MONITOR_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+
+    #include "latency_histogram.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Starvation detector for the writers of a shared resource.
+*
+* Every attempt of a writer to get the resource for an update is recorded
+* with vStarvationMonitorRecord(), whether it succeeded or not.  An update is
+* pending from its first failed attempt until an attempt succeeds, and the
+* monitor records:
+* - the wait: from the first attempt for the update until it is done;
+* - the skips: failed attempts before it is done;
+* - the age: time since the previous update, how stale the data had become.
+* When an update has been pending for longer than the bound, the alarm is
+* raised once, printed with console_print(), and cleared by the next update.
+*
+* Times are in run time counter units - see ulGetRunTimeCounterValue().  The
+* monitor can be shared by several writers, it updates itself in critical
+* sections.
+*----------------------------------------------------------*/
+
+    typedef struct StarvationMonitor
+    {
+        const char * pcName;
+        unsigned long ulBound;       /* Pending time that raises the alarm. */
+        unsigned long ulPendingSince;/* First failed attempt, 0 when nothing is pending. */
+        unsigned long ulLastUpdate;  /* 0 before the first update. */
+        uint32_t ulSkipsPending;
+        BaseType_t xAlarmRaised;
+
+        /* Statistics. */
+        uint32_t ulAttempts;
+        uint32_t ulUpdates;
+        uint32_t ulSkipped;
+        uint32_t ulAlarms;
+        LatencyHistogram_t xWait;
+        LatencyHistogram_t xSkips;
+        LatencyHistogram_t xAge;
+    } StarvationMonitor_t;
+
+    void vStarvationMonitorInit( StarvationMonitor_t * pxMonitor,
+                                 const char * pcName,
+                                 uint32_t ulBoundMs );
+
+/*
+ * ulAttemptStart is the run time counter value read before trying to get
+ * the resource, xUpdated whether it was obtained.
+ */
+    void vStarvationMonitorRecord( StarvationMonitor_t * pxMonitor,
+                                   unsigned long ulAttemptStart,
+                                   BaseType_t xUpdated );
+
+/* Prints the counters and the histograms with console_print(). */
+    void vStarvationMonitorReport( const StarvationMonitor_t * pxMonitor );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* STARVATION_MONITOR_H */
@@ -0,0 +1,106 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Binary signal to one waiting task - see task_signal.h.
+*----------------------------------------------------------*/
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "task_signal.h"
+
+/*-----------------------------------------------------------*/
+
+void vSemaphoreSignalCreate( SemaphoreSignal_t * pxSignal,
+                             TaskHandle_t xWaiter )
+{
+    /* Any task can take a semaphore. */
+    ( void ) xWaiter;
+
+    pxSignal->xSemaphore = xSemaphoreCreateBinaryStatic( &pxSignal->xSemaphoreBuffer );
+    configASSERT( pxSignal->xSemaphore );
+}
+/*-----------------------------------------------------------*/
+
+void vSemaphoreSignalDelete( SemaphoreSignal_t * pxSignal )
+{
+    vSemaphoreDelete( pxSignal->xSemaphore );
+    pxSignal->xSemaphore = NULL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xSemaphoreSignalGive( SemaphoreSignal_t * pxSignal )
+{
+    return xSemaphoreGive( pxSignal->xSemaphore );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xSemaphoreSignalTake( SemaphoreSignal_t * pxSignal,
+                                 TickType_t xTicksToWait )
+{
+    return xSemaphoreTake( pxSignal->xSemaphore, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+void vNotifySignalCreate( NotifySignal_t * pxSignal,
+                          TaskHandle_t xWaiter )
+{
+    configASSERT( xWaiter );
+
+    /* Drop whatever was left in the notification by an earlier user. */
+    ( void ) xTaskNotifyStateClear( xWaiter );
+    ( void ) ulTaskNotifyValueClear( xWaiter, UINT32_MAX );
+    pxSignal->xWaiter = xWaiter;
+}
+/*-----------------------------------------------------------*/
+
+void vNotifySignalDelete( NotifySignal_t * pxSignal )
+{
+    /* The waiter may already be deleted - there is nothing to free. */
+    pxSignal->xWaiter = NULL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNotifySignalGive( NotifySignal_t * pxSignal )
+{
+    return xTaskNotifyGive( pxSignal->xWaiter );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNotifySignalTake( NotifySignal_t * pxSignal,
+                              TickType_t xTicksToWait )
+{
+    configASSERT( pxSignal->xWaiter == xTaskGetCurrentTaskHandle() );
+
+    /* Clearing the count on exit turns the counting notification into a
+     * binary one - several gives before a take leave a single signal. */
+    return ( ulTaskNotifyTake( pdTRUE, xTicksToWait ) != 0 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,84 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TASK_SIGNAL_H
+    #define TASK_SIGNAL_H
+
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "semphr.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Binary signal from any task to one waiting task.
+*
+* Two implementations of the same binary semaphore semantics are provided:
+* - SemaphoreSignal_t, built on xSemaphoreCreateBinaryStatic();
+* - NotifySignal_t, built on the direct to task notification (index 0) of the
+*   waiting task, which costs no kernel object at all - but only the task
+*   named when the signal is created may take it.
+*
+* --bench=signal measures the signal to wake latency of both.
+*----------------------------------------------------------*/
+
+    #if ( configUSE_TASK_NOTIFICATIONS != 1 )
+        #error "NotifySignal_t needs configUSE_TASK_NOTIFICATIONS set to 1"
+    #endif
+
+    typedef struct SemaphoreSignal
+    {
+        SemaphoreHandle_t xSemaphore;
+        StaticSemaphore_t xSemaphoreBuffer;
+    } SemaphoreSignal_t;
+
+    typedef struct NotifySignal
+    {
+        TaskHandle_t xWaiter;
+    } NotifySignal_t;
+
+/* Signals start in the not signalled state, as xSemaphoreCreateBinary(). */
+    void vSemaphoreSignalCreate( SemaphoreSignal_t * pxSignal,
+                                 TaskHandle_t xWaiter );
+    void vSemaphoreSignalDelete( SemaphoreSignal_t * pxSignal );
+    BaseType_t xSemaphoreSignalGive( SemaphoreSignal_t * pxSignal );
+    BaseType_t xSemaphoreSignalTake( SemaphoreSignal_t * pxSignal,
+                                     TickType_t xTicksToWait );
+
+    void vNotifySignalCreate( NotifySignal_t * pxSignal,
+                              TaskHandle_t xWaiter );
+    void vNotifySignalDelete( NotifySignal_t * pxSignal );
+    BaseType_t xNotifySignalGive( NotifySignal_t * pxSignal );
+    BaseType_t xNotifySignalTake( NotifySignal_t * pxSignal,
+                                  TickType_t xTicksToWait );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* TASK_SIGNAL_H */
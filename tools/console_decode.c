@@ -0,0 +1,236 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Decodes the binary log written by the console in eConsoleBinary mode (see
+ * console_set_binary_file() and binary_log.h), one line per message:
+ *
+ *     [seconds.nanoseconds] task: text
+ *
+ * The task is the handle of the task that logged the message, as the log
+ * does not carry task names.  Build with "make console_decode".
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "binary_log.h"
+
+/* The text of a message is formatted into this buffer, and cut if longer. */
+#define decodeMAX_TEXT_LENGTH    ( 4096U )
+
+typedef struct Format
+{
+    uint64_t ullId;
+    char * pcText;
+} Format_t;
+
+static Format_t * pxFormats = NULL;
+static size_t xFormatCount = 0;
+static size_t xFormatCapacity = 0;
+
+/*-----------------------------------------------------------*/
+
+static int prvRead( FILE * pxFile,
+                    void * pvBuffer,
+                    size_t xSize )
+{
+    return ( xSize == 0 ) || ( fread( pvBuffer, 1, xSize, pxFile ) == xSize );
+}
+/*-----------------------------------------------------------*/
+
+static const char * prvFindFormat( uint64_t ullId )
+{
+    /* Latest first - an address can be reused by a later format */
+    for( size_t x = xFormatCount; x > 0; x-- )
+    {
+        if( pxFormats[ x - 1 ].ullId == ullId )
+        {
+            return pxFormats[ x - 1 ].pcText;
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static int prvReadFormat( FILE * pxFile )
+{
+    uint64_t ullId;
+    uint16_t usLength;
+    char * pcText;
+
+    if( !prvRead( pxFile, &ullId, sizeof( ullId ) ) ||
+        !prvRead( pxFile, &usLength, sizeof( usLength ) ) )
+    {
+        return 0;
+    }
+
+    pcText = malloc( ( size_t ) usLength + 1 );
+
+    if( ( pcText == NULL ) || !prvRead( pxFile, pcText, usLength ) )
+    {
+        free( pcText );
+        return 0;
+    }
+
+    pcText[ usLength ] = '\0';
+
+    if( xFormatCount == xFormatCapacity )
+    {
+        size_t xCapacity = ( xFormatCapacity == 0 ) ? 64 : 2 * xFormatCapacity;
+        Format_t * pxGrown = realloc( pxFormats, xCapacity * sizeof( Format_t ) );
+
+        if( pxGrown == NULL )
+        {
+            free( pcText );
+            return 0;
+        }
+
+        pxFormats = pxGrown;
+        xFormatCapacity = xCapacity;
+    }
+
+    pxFormats[ xFormatCount ].ullId = ullId;
+    pxFormats[ xFormatCount ].pcText = pcText;
+    xFormatCount++;
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+static int prvReadMessage( FILE * pxFile )
+{
+    static uint8_t ucArguments[ UINT16_MAX ];
+    static char cText[ decodeMAX_TEXT_LENGTH ];
+    BinaryLogHeader_t xHeader;
+    const char * pcFormat;
+    size_t xLength;
+
+    if( !prvRead( pxFile, &xHeader.ullTimestamp, sizeof( xHeader.ullTimestamp ) ) ||
+        !prvRead( pxFile, &xHeader.ullFormat, sizeof( xHeader.ullFormat ) ) ||
+        !prvRead( pxFile, &xHeader.ullTask, sizeof( xHeader.ullTask ) ) ||
+        !prvRead( pxFile, &xHeader.ucFlags, sizeof( xHeader.ucFlags ) ) ||
+        !prvRead( pxFile, &xHeader.usLength, sizeof( xHeader.usLength ) ) ||
+        !prvRead( pxFile, ucArguments, xHeader.usLength ) )
+    {
+        return 0;
+    }
+
+    pcFormat = prvFindFormat( xHeader.ullFormat );
+
+    if( pcFormat == NULL )
+    {
+        fprintf( stderr, "Message with an unknown format 0x%llx\n", ( unsigned long long ) xHeader.ullFormat );
+        return 0;
+    }
+
+    xLength = xBinaryLogFormat( cText, sizeof( cText ), pcFormat, ucArguments,
+                                xHeader.usLength, xHeader.ucFlags );
+
+    printf( "[%5llu.%09llu] 0x%llx: %s%s",
+            ( unsigned long long ) ( xHeader.ullTimestamp / 1000000000ULL ),
+            ( unsigned long long ) ( xHeader.ullTimestamp % 1000000000ULL ),
+            ( unsigned long long ) xHeader.ullTask,
+            cText,
+            ( ( xLength > 0 ) && ( cText[ xLength - 1 ] == '\n' ) ) ? "" : "\n" );
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char * argv[] )
+{
+    char cMagic[ binlogMAGIC_LENGTH ];
+    unsigned long ulMessages = 0;
+    uint8_t ucType;
+    FILE * pxFile;
+    int iResult = 0;
+
+    if( argc != 2 )
+    {
+        fprintf( stderr, "Usage: %s FILE\n", argv[ 0 ] );
+        return 1;
+    }
+
+    pxFile = fopen( argv[ 1 ], "rb" );
+
+    if( pxFile == NULL )
+    {
+        perror( argv[ 1 ] );
+        return 1;
+    }
+
+    if( !prvRead( pxFile, cMagic, sizeof( cMagic ) ) ||
+        ( memcmp( cMagic, binlogMAGIC, binlogMAGIC_LENGTH ) != 0 ) )
+    {
+        fprintf( stderr, "%s is not a binary log\n", argv[ 1 ] );
+        fclose( pxFile );
+        return 1;
+    }
+
+    while( fread( &ucType, sizeof( ucType ), 1, pxFile ) == 1 )
+    {
+        if( ucType == binlogTYPE_FORMAT )
+        {
+            if( !prvReadFormat( pxFile ) )
+            {
+                iResult = 1;
+                break;
+            }
+        }
+        else if( ( ucType == binlogTYPE_MESSAGE ) && prvReadMessage( pxFile ) )
+        {
+            ulMessages++;
+        }
+        else
+        {
+            iResult = 1;
+            break;
+        }
+    }
+
+    if( iResult != 0 )
+    {
+        /* A log cut short by the end of the program is still worth reading */
+        fprintf( stderr, "%s: stopped at a truncated or corrupt record after %lu message(s)\n",
+                 argv[ 1 ], ulMessages );
+    }
+
+    for( size_t x = 0; x < xFormatCount; x++ )
+    {
+        free( pxFormats[ x ].pcText );
+    }
+
+    free( pxFormats );
+    fclose( pxFile );
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,142 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Extracts the log written by the console to --log-file (see mmap_log.h),
+ * oldest first, to stdout.  When the ring wrapped, the first line, which the
+ * writer overwrote the start of, is left out.  Build with "make log_reader".
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mmap_log.h"
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char * argv[] )
+{
+    const MmapLogHeader_t * pxHeader;
+    const uint8_t * pucData;
+    uint64_t ullCapacity, ullReserved, ullCommitted, ullStart;
+    struct stat xStat;
+    void * pvMapped;
+    int iFd;
+
+    if( argc != 2 )
+    {
+        fprintf( stderr, "Usage: %s FILE\n", argv[ 0 ] );
+        return 1;
+    }
+
+    iFd = open( argv[ 1 ], O_RDONLY );
+
+    if( ( iFd < 0 ) || ( fstat( iFd, &xStat ) != 0 ) )
+    {
+        perror( argv[ 1 ] );
+        return 1;
+    }
+
+    if( ( size_t ) xStat.st_size < sizeof( MmapLogHeader_t ) )
+    {
+        fprintf( stderr, "%s is not a log file\n", argv[ 1 ] );
+        close( iFd );
+        return 1;
+    }
+
+    /* Mapped rather than read, so that a log still being written can be
+     * looked at too - the cursors are read before the data. */
+    pvMapped = mmap( NULL, ( size_t ) xStat.st_size, PROT_READ, MAP_SHARED, iFd, 0 );
+    close( iFd );
+
+    if( pvMapped == MAP_FAILED )
+    {
+        perror( argv[ 1 ] );
+        return 1;
+    }
+
+    pxHeader = pvMapped;
+
+    if( ( memcmp( pxHeader->cMagic, mmaplogMAGIC, mmaplogMAGIC_LENGTH ) != 0 ) ||
+        ( pxHeader->ulVersion != mmaplogVERSION ) ||
+        ( ( uint64_t ) xStat.st_size < pxHeader->ulDataOffset + pxHeader->ullCapacity ) ||
+        ( pxHeader->ullCapacity == 0 ) )
+    {
+        fprintf( stderr, "%s is not a log file, or of another version\n", argv[ 1 ] );
+        munmap( pvMapped, ( size_t ) xStat.st_size );
+        return 1;
+    }
+
+    pucData = ( const uint8_t * ) pvMapped + pxHeader->ulDataOffset;
+    ullCapacity = pxHeader->ullCapacity;
+    ullCommitted = __atomic_load_n( &pxHeader->ullCommitted, __ATOMIC_ACQUIRE );
+    ullReserved = __atomic_load_n( &pxHeader->ullReserved, __ATOMIC_ACQUIRE );
+
+    if( ullReserved != ullCommitted )
+    {
+        fprintf( stderr, "%s: the last write, of %llu bytes, did not complete\n",
+                 argv[ 1 ], ( unsigned long long ) ( ullReserved - ullCommitted ) );
+    }
+
+    ullStart = ( ullReserved > ullCapacity ) ? ullReserved - ullCapacity : 0;
+
+    if( ullStart > 0 )
+    {
+        while( ( ullStart < ullCommitted ) && ( pucData[ ullStart % ullCapacity ] != '\n' ) )
+        {
+            ullStart++;
+        }
+
+        ullStart++;
+        fprintf( stderr, "%s: the log wrapped, the first %llu bytes were overwritten\n",
+                 argv[ 1 ], ( unsigned long long ) ullStart );
+    }
+
+    while( ullStart < ullCommitted )
+    {
+        size_t xOffset = ( size_t ) ( ullStart % ullCapacity );
+        size_t xLength = ( size_t ) ( ullCommitted - ullStart );
+
+        if( xLength > ullCapacity - xOffset )
+        {
+            xLength = ( size_t ) ( ullCapacity - xOffset );
+        }
+
+        fwrite( &pucData[ xOffset ], 1, xLength, stdout );
+        ullStart += xLength;
+    }
+
+    munmap( pvMapped, ( size_t ) xStat.st_size );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
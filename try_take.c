@@ -0,0 +1,190 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Instrumented try-take with back-off policies - see try_take.h.
+*----------------------------------------------------------*/
+
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "try_take.h"
+#include "console.h"
+
+/* Longest sleep of the exponential back-off, in ticks. */
+#define tryMAX_BACKOFF_TICKS    ( ( TickType_t ) 64 )
+
+static const char * const pcPolicyNames[ eBackoffCount ] =
+{
+    [ eBackoffNone ]        = "none",
+    [ eBackoffImmediate ]   = "immediate",
+    [ eBackoffExponential ] = "exponential",
+    [ eBackoffYield ]       = "yield",
+    [ eBackoffBoundedWait ] = "bounded"
+};
+
+/*-----------------------------------------------------------*/
+
+const char * pcBackoffPolicyName( BackoffPolicy_t xPolicy )
+{
+    return ( xPolicy < eBackoffCount ) ? pcPolicyNames[ xPolicy ] : "?";
+}
+/*-----------------------------------------------------------*/
+
+void vTryTakeInit( TryTakeSemaphore_t * pxTry,
+                   SemaphoreHandle_t xSemaphore,
+                   const char * pcName,
+                   BackoffPolicy_t xPolicy,
+                   uint32_t ulMaxRetries,
+                   TickType_t xBoundedWait )
+{
+    memset( pxTry, 0, sizeof( *pxTry ) );
+    pxTry->xSemaphore = xSemaphore;
+    pxTry->pcName = pcName;
+    pxTry->xPolicy = xPolicy;
+    pxTry->ulMaxRetries = ulMaxRetries;
+    pxTry->xBoundedWait = xBoundedWait;
+}
+/*-----------------------------------------------------------*/
+
+/* Must be called from within a critical section.  Returns NULL once
+ * tryMAX_TASKS tasks have their own counters. */
+static TryTakeCounters_t * prvCountersOfTask( TryTakeSemaphore_t * pxTry )
+{
+    TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+
+    for( UBaseType_t x = 0; x < tryMAX_TASKS; x++ )
+    {
+        if( pxTry->xTasks[ x ] == NULL )
+        {
+            pxTry->xTasks[ x ] = xTask;
+            strncpy( pxTry->cTaskNames[ x ], pcTaskGetName( xTask ), configMAX_TASK_NAME_LEN - 1 );
+        }
+
+        if( pxTry->xTasks[ x ] == xTask )
+        {
+            return &pxTry->xPerTask[ x ];
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCount( TryTakeSemaphore_t * pxTry,
+                      uint32_t ulAttempts,
+                      BaseType_t xAcquired )
+{
+    taskENTER_CRITICAL();
+    {
+        TryTakeCounters_t * pxCounters[ 2 ] = { &pxTry->xTotal, prvCountersOfTask( pxTry ) };
+
+        for( int x = 0; x < 2; x++ )
+        {
+            if( pxCounters[ x ] != NULL )
+            {
+                pxCounters[ x ]->ulAttempts += ulAttempts;
+                pxCounters[ x ]->ulFailures += ( xAcquired == pdTRUE ) ? ulAttempts - 1U : ulAttempts;
+                pxCounters[ x ]->ulAcquired += ( xAcquired == pdTRUE ) ? 1U : 0U;
+                pxCounters[ x ]->ulLost += ( xAcquired == pdTRUE ) ? 0U : 1U;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTryTake( TryTakeSemaphore_t * pxTry )
+{
+    BaseType_t xAcquired = xSemaphoreTake( pxTry->xSemaphore, 0 );
+    uint32_t ulAttempts = 1;
+    TickType_t xBackoff = 1;
+
+    while( ( xAcquired == pdFALSE ) && ( pxTry->xPolicy != eBackoffNone ) )
+    {
+        if( pxTry->xPolicy == eBackoffBoundedWait )
+        {
+            /* One more attempt, but a blocking one. */
+            xAcquired = xSemaphoreTake( pxTry->xSemaphore, pxTry->xBoundedWait );
+            ulAttempts++;
+            break;
+        }
+
+        if( ulAttempts > pxTry->ulMaxRetries )
+        {
+            break;
+        }
+
+        if( pxTry->xPolicy == eBackoffExponential )
+        {
+            vTaskDelay( xBackoff );
+            xBackoff = ( xBackoff * 2 < tryMAX_BACKOFF_TICKS ) ? xBackoff * 2 : tryMAX_BACKOFF_TICKS;
+        }
+        else if( pxTry->xPolicy == eBackoffYield )
+        {
+            taskYIELD();
+        }
+
+        xAcquired = xSemaphoreTake( pxTry->xSemaphore, 0 );
+        ulAttempts++;
+    }
+
+    prvCount( pxTry, ulAttempts, xAcquired );
+
+    return xAcquired;
+}
+/*-----------------------------------------------------------*/
+
+void vTryTakeReport( const TryTakeSemaphore_t * pxTry )
+{
+    console_print( "Try-takes of %s, back-off '%s'\n", pxTry->pcName, pcBackoffPolicyName( pxTry->xPolicy ) );
+    console_print( "%-12s %10s %10s %10s %10s\n", "Task", "Attempts", "Failures", "Acquired", "Lost" );
+
+    for( UBaseType_t x = 0; ( x < tryMAX_TASKS ) && ( pxTry->xTasks[ x ] != NULL ); x++ )
+    {
+        const TryTakeCounters_t * pxCounters = &pxTry->xPerTask[ x ];
+
+        console_print( "%-12s %10lu %10lu %10lu %10lu\n",
+                       pxTry->cTaskNames[ x ],
+                       ( unsigned long ) pxCounters->ulAttempts,
+                       ( unsigned long ) pxCounters->ulFailures,
+                       ( unsigned long ) pxCounters->ulAcquired,
+                       ( unsigned long ) pxCounters->ulLost );
+    }
+
+    console_print( "%-12s %10lu %10lu %10lu %10lu\n",
+                   "total",
+                   ( unsigned long ) pxTry->xTotal.ulAttempts,
+                   ( unsigned long ) pxTry->xTotal.ulFailures,
+                   ( unsigned long ) pxTry->xTotal.ulAcquired,
+                   ( unsigned long ) pxTry->xTotal.ulLost );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,106 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TRY_TAKE_H
+    #define TRY_TAKE_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "semphr.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Instrumented try-take of a semaphore.
+*
+* xTryTake() replaces xSemaphoreTake( xSemaphore, 0 ) in code that drops its
+* work when the semaphore is busy.  What it does after a failed attempt is
+* set by the back-off policy of the semaphore, and every attempt, failure and
+* lost piece of work (the policy gave up) is counted - in total, and for each
+* of the first tryMAX_TASKS tasks using it.
+*----------------------------------------------------------*/
+
+    #ifndef tryMAX_TASKS
+        #define tryMAX_TASKS    ( 16U )
+    #endif
+
+    typedef enum
+    {
+        eBackoffNone = 0,     /* Give up after the first failure - a plain try-take. */
+        eBackoffImmediate,    /* Retry straight away, up to ulMaxRetries times. */
+        eBackoffExponential,  /* Sleep 1, 2, 4 .. ticks between up to ulMaxRetries retries. */
+        eBackoffYield,        /* Yield to the tasks of the same priority before each retry. */
+        eBackoffBoundedWait,  /* Block for at most xBoundedWait ticks. */
+        eBackoffCount
+    } BackoffPolicy_t;
+
+    typedef struct TryTakeCounters
+    {
+        uint32_t ulAttempts;   /* xSemaphoreTake() calls. */
+        uint32_t ulFailures;   /* ... that did not get the semaphore. */
+        uint32_t ulAcquired;   /* xTryTake() calls that got it. */
+        uint32_t ulLost;       /* xTryTake() calls that gave up. */
+    } TryTakeCounters_t;
+
+    typedef struct TryTakeSemaphore
+    {
+        SemaphoreHandle_t xSemaphore;
+        const char * pcName;
+        BackoffPolicy_t xPolicy;
+        uint32_t ulMaxRetries;
+        TickType_t xBoundedWait;
+
+        TryTakeCounters_t xTotal;
+        TaskHandle_t xTasks[ tryMAX_TASKS ];
+        char cTaskNames[ tryMAX_TASKS ][ configMAX_TASK_NAME_LEN ]; /* Kept, tasks may be gone by the report. */
+        TryTakeCounters_t xPerTask[ tryMAX_TASKS ];
+    } TryTakeSemaphore_t;
+
+    void vTryTakeInit( TryTakeSemaphore_t * pxTry,
+                       SemaphoreHandle_t xSemaphore,
+                       const char * pcName,
+                       BackoffPolicy_t xPolicy,
+                       uint32_t ulMaxRetries,
+                       TickType_t xBoundedWait );
+
+/* Returns pdTRUE if the semaphore was obtained - give it back with
+ * xSemaphoreGive( pxTry->xSemaphore ). */
+    BaseType_t xTryTake( TryTakeSemaphore_t * pxTry );
+
+/* Prints the counters, in total and per task, with console_print(). */
+    void vTryTakeReport( const TryTakeSemaphore_t * pxTry );
+
+    const char * pcBackoffPolicyName( BackoffPolicy_t xPolicy );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* TRY_TAKE_H */
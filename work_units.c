@@ -0,0 +1,129 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Calibrated busy work - see work_units.h.
+*----------------------------------------------------------*/
+
+#include <time.h>
+
+/* Local includes. */
+#include "work_units.h"
+
+/* Calibration keeps doubling the number of units until one trial lasts at
+ * least workMIN_TRIAL_NS, and keeps the fastest of workTRIALS trials. */
+#define workMIN_TRIAL_NS    ( 10000000ULL )
+#define workTRIALS          ( 5 )
+
+/* Units per millisecond, until vWorkCalibrate() is called. */
+static uint64_t ullUnitsPerMs = 100000ULL;
+
+/* Where the result of the work goes, so that it is observable. */
+static volatile uint32_t ulWorkSink;
+
+/*-----------------------------------------------------------*/
+
+void vWorkBurnUnits( uint64_t ullUnits )
+{
+    uint32_t ulState = ulWorkSink | 1U;
+
+    for( uint64_t x = 0; x < ullUnits; x++ )
+    {
+        ulState = ulState * 1664525U + 1013904223U;
+
+        /* Hides the value from the optimiser, so that the chain can be
+         * neither folded nor vectorised - it costs no instruction. */
+        __asm volatile ( "" : "+r" ( ulState ) );
+    }
+
+    ulWorkSink = ulState;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+void vWorkCalibrate( void )
+{
+    uint64_t ullUnits = 1024;
+    uint64_t ullBestNs = UINT64_MAX;
+    uint64_t ullElapsed;
+
+    /* Find a number of units long enough to be timed accurately. */
+    do
+    {
+        ullUnits *= 2;
+        ullElapsed = prvNowNs();
+        vWorkBurnUnits( ullUnits );
+        ullElapsed = prvNowNs() - ullElapsed;
+    } while( ullElapsed < workMIN_TRIAL_NS );
+
+    /* The fastest trial is the one least disturbed by the host. */
+    for( int x = 0; x < workTRIALS; x++ )
+    {
+        ullElapsed = prvNowNs();
+        vWorkBurnUnits( ullUnits );
+        ullElapsed = prvNowNs() - ullElapsed;
+
+        if( ullElapsed < ullBestNs )
+        {
+            ullBestNs = ullElapsed;
+        }
+    }
+
+    ullUnitsPerMs = ( ullUnits * 1000000ULL ) / ( ullBestNs > 0 ? ullBestNs : 1 );
+
+    if( ullUnitsPerMs == 0 )
+    {
+        ullUnitsPerMs = 1;
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullWorkUnitsPerMs( void )
+{
+    return ullUnitsPerMs;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullWorkUnitsForUs( uint32_t ulMicroseconds )
+{
+    return ( ( uint64_t ) ulMicroseconds * ullUnitsPerMs ) / 1000ULL;
+}
+/*-----------------------------------------------------------*/
+
+void vWorkBurnUs( uint32_t ulMicroseconds )
+{
+    vWorkBurnUnits( ullWorkUnitsForUs( ulMicroseconds ) );
+}
+/*-----------------------------------------------------------*/
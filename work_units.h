@@ -0,0 +1,57 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef WORK_UNITS_H
+    #define WORK_UNITS_H
+
+    #include <stdint.h>
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Calibrated busy work, used to give critical sections a known length.
+*
+* A work unit is one step of a dependent integer chain the compiler cannot
+* remove or collapse, whatever the optimisation level.  vWorkCalibrate()
+* measures once, before the scheduler starts, how many units run per
+* millisecond on this host and build, so that a length given in microseconds
+* translates into the same amount of work on every call - being preempted in
+* the middle of it does not shorten it.
+*----------------------------------------------------------*/
+
+    void vWorkCalibrate( void );
+    uint64_t ullWorkUnitsPerMs( void );
+    uint64_t ullWorkUnitsForUs( uint32_t ulMicroseconds );
+    void vWorkBurnUnits( uint64_t ullUnits );
+    void vWorkBurnUs( uint32_t ulMicroseconds );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* WORK_UNITS_H */
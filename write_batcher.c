@@ -0,0 +1,205 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+* Write coalescing front end - see write_batcher.h.
+*----------------------------------------------------------*/
+
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "write_batcher.h"
+#include "console.h"
+#include "run_time_stats.h"
+
+/* Largest change the writer task copies out of the queue. */
+#define batcherMAX_CHANGE_SIZE    ( 64U )
+
+static void prvWriterTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+void vWriteBatcherInit( WriteBatcher_t * pxBatcher,
+                        UBaseType_t uxQueueLength,
+                        UBaseType_t uxChangeSize,
+                        WriteBatchLock_t pxLock,
+                        WriteBatchUnlock_t pxUnlock,
+                        WriteBatchApply_t pxApply,
+                        void * pvContext )
+{
+    configASSERT( ( uxChangeSize > 0 ) && ( uxChangeSize <= batcherMAX_CHANGE_SIZE ) );
+
+    memset( pxBatcher, 0, sizeof( *pxBatcher ) );
+    pxBatcher->xQueue = xQueueCreate( uxQueueLength, uxChangeSize );
+    configASSERT( pxBatcher->xQueue != NULL );
+    pxBatcher->uxChangeSize = uxChangeSize;
+    pxBatcher->pxLock = pxLock;
+    pxBatcher->pxUnlock = pxUnlock;
+    pxBatcher->pxApply = pxApply;
+    pxBatcher->pvContext = pvContext;
+    pxBatcher->xStopped = xSemaphoreCreateBinaryStatic( &pxBatcher->xStoppedBuffer );
+    vHistogramReset( &pxBatcher->xBatchSize );
+    vHistogramReset( &pxBatcher->xHold );
+}
+/*-----------------------------------------------------------*/
+
+void vWriteBatcherDelete( WriteBatcher_t * pxBatcher )
+{
+    configASSERT( pxBatcher->xRunning == pdFALSE );
+    vQueueDelete( pxBatcher->xQueue );
+    vSemaphoreDelete( pxBatcher->xStopped );
+}
+/*-----------------------------------------------------------*/
+
+void vWriteBatcherStart( WriteBatcher_t * pxBatcher,
+                         UBaseType_t uxPriority,
+                         configSTACK_DEPTH_TYPE usStackDepth )
+{
+    pxBatcher->xRunning = pdTRUE;
+    xTaskCreate( prvWriterTask, "Batcher", usStackDepth, pxBatcher, uxPriority, &pxBatcher->xWriter );
+}
+/*-----------------------------------------------------------*/
+
+void vWriteBatcherStop( WriteBatcher_t * pxBatcher )
+{
+    pxBatcher->xRunning = pdFALSE;
+    xTaskAbortDelay( pxBatcher->xWriter );
+
+    while( xSemaphoreTake( pxBatcher->xStopped, portMAX_DELAY ) != pdTRUE )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWriteBatcherSubmit( WriteBatcher_t * pxBatcher,
+                                const void * pvChange )
+{
+    __atomic_add_fetch( &pxBatcher->ulSubmitted, 1U, __ATOMIC_RELAXED );
+
+    if( xQueueSend( pxBatcher->xQueue, pvChange, 0 ) != pdPASS )
+    {
+        __atomic_add_fetch( &pxBatcher->ulDropped, 1U, __ATOMIC_RELAXED );
+        return pdFALSE;
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/* Applies the change already received and everything queued behind it in one
+ * exclusive section.  A change left when the lock cannot be obtained is
+ * applied with the next batch. */
+static BaseType_t prvApplyBatch( WriteBatcher_t * pxBatcher,
+                                 uint8_t * pucChange )
+{
+    uint32_t ulBatch = 0;
+
+    if( pxBatcher->pxLock( pxBatcher->pvContext ) != pdTRUE )
+    {
+        pxBatcher->ulLockFailures++;
+        return pdFALSE;
+    }
+
+    unsigned long ulStart = ulGetRunTimeCounterValue();
+
+    do
+    {
+        pxBatcher->pxApply( pxBatcher->pvContext, pucChange );
+        ulBatch++;
+    } while( xQueueReceive( pxBatcher->xQueue, pucChange, 0 ) == pdPASS );
+
+    pxBatcher->pxUnlock( pxBatcher->pvContext );
+
+    vHistogramRecord( &pxBatcher->xHold, ulGetRunTimeCounterValue() - ulStart );
+    vHistogramRecord( &pxBatcher->xBatchSize, ulBatch );
+    pxBatcher->ulApplied += ulBatch;
+    pxBatcher->ulBatches++;
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriterTask( void * pvParameters )
+{
+    WriteBatcher_t * pxBatcher = ( WriteBatcher_t * ) pvParameters;
+    uint8_t ucChange[ batcherMAX_CHANGE_SIZE ];
+    BaseType_t xHaveChange = pdFALSE;
+
+    while( pxBatcher->xRunning == pdTRUE )
+    {
+        if( xHaveChange == pdFALSE )
+        {
+            xHaveChange = xQueueReceive( pxBatcher->xQueue, ucChange, portMAX_DELAY );
+        }
+
+        if( ( xHaveChange == pdTRUE ) && ( prvApplyBatch( pxBatcher, ucChange ) == pdTRUE ) )
+        {
+            xHaveChange = pdFALSE;
+        }
+    }
+
+    /* Nothing submitted before the stop is lost. */
+    if( ( xHaveChange == pdTRUE ) || ( xQueueReceive( pxBatcher->xQueue, ucChange, 0 ) == pdPASS ) )
+    {
+        while( prvApplyBatch( pxBatcher, ucChange ) != pdTRUE )
+        {
+        }
+    }
+
+    xSemaphoreGive( pxBatcher->xStopped );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vWriteBatcherReport( const WriteBatcher_t * pxBatcher,
+                          const char * pcName )
+{
+    console_print( "%s: %lu change(s) submitted, %lu dropped, %lu applied in %lu batch(es), "
+                   "%.2f per batch, %lu lock failure(s)\n",
+                   pcName,
+                   ( unsigned long ) pxBatcher->ulSubmitted,
+                   ( unsigned long ) pxBatcher->ulDropped,
+                   ( unsigned long ) pxBatcher->ulApplied,
+                   ( unsigned long ) pxBatcher->ulBatches,
+                   ( pxBatcher->ulBatches > 0 ) ? ( double ) pxBatcher->ulApplied / ( double ) pxBatcher->ulBatches : 0.0,
+                   ( unsigned long ) pxBatcher->ulLockFailures );
+    console_print( "%-12s %12s %12s %12s\n", "", "p50", "p99", "max" );
+    console_print( "%-12s %12llu %12llu %12llu\n", "Batch size",
+                   ( unsigned long long ) ullHistogramPercentile( &pxBatcher->xBatchSize, 50.0 ),
+                   ( unsigned long long ) ullHistogramPercentile( &pxBatcher->xBatchSize, 99.0 ),
+                   ( unsigned long long ) ( ( pxBatcher->xBatchSize.ullCount > 0 ) ? pxBatcher->xBatchSize.ullMax : 0 ) );
+    console_print( "%-12s %12llu %12llu %12llu\n", "Hold us",
+                   ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxBatcher->xHold, 50.0 ) ),
+                   ( unsigned long long ) runtimeCOUNTS_TO_US( ullHistogramPercentile( &pxBatcher->xHold, 99.0 ) ),
+                   ( unsigned long long ) runtimeCOUNTS_TO_US( ( pxBatcher->xHold.ullCount > 0 ) ? pxBatcher->xHold.ullMax : 0 ) );
+}
+/*-----------------------------------------------------------*/
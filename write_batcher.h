@@ -0,0 +1,119 @@
+/*
+ * FreeRTOS V202111.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef WRITE_BATCHER_H
+    #define WRITE_BATCHER_H
+
+    #include <stdint.h>
+
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "queue.h"
+    #include "semphr.h"
+
+    #include "latency_histogram.h"
+
+    #ifdef __cplusplus
+        extern "C" {
+    #endif
+
+/*-----------------------------------------------------------
+* Write coalescing front end for a resource behind an exclusive lock.
+*
+* Producers hand their changes to xWriteBatcherSubmit(), which copies them
+* into a queue and never blocks - a change that does not fit is dropped and
+* counted.  A single writer task, created by vWriteBatcherStart(), waits for
+* the first pending change, takes the exclusive lock once, applies every
+* change pending by then, and releases the lock: changes that arrive faster
+* than the lock can be taken are merged into one exclusive section.
+*
+* The lock and the changes are the caller's, reached through the callbacks.
+* Times are in run time counter units - see ulGetRunTimeCounterValue().
+*----------------------------------------------------------*/
+
+/* Takes the exclusive lock, returning pdFALSE if it could not be obtained. */
+    typedef BaseType_t ( * WriteBatchLock_t )( void * pvContext );
+    typedef void ( * WriteBatchUnlock_t )( void * pvContext );
+    typedef void ( * WriteBatchApply_t )( void * pvContext,
+                                          const void * pvChange );
+
+    typedef struct WriteBatcher
+    {
+        QueueHandle_t xQueue;
+        UBaseType_t uxChangeSize;
+        WriteBatchLock_t pxLock;
+        WriteBatchUnlock_t pxUnlock;
+        WriteBatchApply_t pxApply;
+        void * pvContext;
+        TaskHandle_t xWriter;
+        SemaphoreHandle_t xStopped;
+        StaticSemaphore_t xStoppedBuffer;
+        volatile BaseType_t xRunning;
+
+        /* Statistics - ulSubmitted and ulDropped are updated atomically by
+         * the producers, the others by the writer task only. */
+        uint32_t ulSubmitted;
+        uint32_t ulDropped;   /* The queue was full. */
+        uint32_t ulApplied;
+        uint32_t ulBatches;   /* Exclusive sections. */
+        uint32_t ulLockFailures;
+        LatencyHistogram_t xBatchSize;
+        LatencyHistogram_t xHold; /* Lock obtained -> released. */
+    } WriteBatcher_t;
+
+/*
+ * uxQueueLength changes of uxChangeSize bytes can be pending.  The writer
+ * task is not created before vWriteBatcherStart().
+ */
+    void vWriteBatcherInit( WriteBatcher_t * pxBatcher,
+                            UBaseType_t uxQueueLength,
+                            UBaseType_t uxChangeSize,
+                            WriteBatchLock_t pxLock,
+                            WriteBatchUnlock_t pxUnlock,
+                            WriteBatchApply_t pxApply,
+                            void * pvContext );
+    void vWriteBatcherDelete( WriteBatcher_t * pxBatcher );
+
+    void vWriteBatcherStart( WriteBatcher_t * pxBatcher,
+                             UBaseType_t uxPriority,
+                             configSTACK_DEPTH_TYPE usStackDepth );
+
+/* Applies what is still pending, then waits for the writer task to end. */
+    void vWriteBatcherStop( WriteBatcher_t * pxBatcher );
+
+/* Returns pdFALSE, without waiting, if the change was dropped. */
+    BaseType_t xWriteBatcherSubmit( WriteBatcher_t * pxBatcher,
+                                    const void * pvChange );
+
+/* Prints the counters and the histograms with console_print(). */
+    void vWriteBatcherReport( const WriteBatcher_t * pxBatcher,
+                              const char * pcName );
+
+    #ifdef __cplusplus
+        }
+    #endif
+
+#endif /* WRITE_BATCHER_H */